@@ -30,12 +30,23 @@
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <iostream>
+#include <map>
 #include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
 #include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 extern "C" {
 #include <time.h>
 }
+#if defined(__i386__) || defined(__x86_64__)
+    #include <cpuid.h>
+    #include <x86intrin.h>
+#endif
 
 // -------------------------------------------------------------------------- //
 
@@ -115,6 +126,9 @@ public:
 EXCEPTION(Unreachable, Any, "unreachable code reached");
 EXCEPTION(Bounded, Any, "bounded execution exception");
     EXCEPTION(BoundedOverrun, Any, "bounded execution overrun");
+EXCEPTION(Argument, Any, "invalid command line argument");
+    EXCEPTION(ArgumentUnknown, Argument, "unknown command line option");
+    EXCEPTION(ArgumentValue, Argument, "invalid command line option value");
 
 }
 // -------------------------------------------------------------------------- //
@@ -133,6 +147,91 @@ protected:
     NonCopyable() = default;
 };
 
+/** Command line arguments class, separating '--name=value' options from positional arguments.
+**/
+class Arguments final: private NonCopyable {
+private:
+    ::std::vector<char const*>                 positionals; // Positional arguments, in order
+    ::std::map<::std::string, ::std::string>       options; // Option values by name ('--name' alone maps to an empty value)
+    ::std::set<::std::string>              mutable queried; // Names of the options queried so far
+public:
+    /** Parsing constructor, a lone '--' ends the options.
+     * @param argc Arguments count
+     * @param argv Arguments values (the program name excluded)
+    **/
+    Arguments(int argc, char** argv) {
+        auto opts = true;
+        for (auto i = 1; i < argc; ++i) {
+            ::std::string arg{argv[i]};
+            if (!opts || arg.compare(0, 2, "--") != 0) {
+                positionals.push_back(argv[i]);
+            } else if (arg.size() == 2) {
+                opts = false;
+            } else {
+                auto pos = arg.find('=');
+                if (pos == ::std::string::npos) {
+                    options[arg.substr(2)] = "";
+                } else {
+                    options[arg.substr(2, pos - 2)] = arg.substr(pos + 1);
+                }
+            }
+        }
+    }
+public:
+    /** Get the number of positional arguments.
+     * @return Number of positional arguments
+    **/
+    auto size() const noexcept {
+        return positionals.size();
+    }
+    /** Get a positional argument.
+     * @param index Index of the positional argument
+     * @return Null-terminated positional argument
+    **/
+    auto operator[](size_t index) const noexcept {
+        return positionals[index];
+    }
+    /** Get the value of an option, throw 'Exception::ArgumentValue' if it cannot be parsed.
+     * @param name Name of the option (without the leading '--')
+     * @param def  Default value, if the option is not set
+     * @return Parsed value, or the default one
+    **/
+    template<class Type> Type get(char const* name, Type const& def) const {
+        queried.emplace(name);
+        auto&& iter = options.find(name);
+        if (iter == options.end())
+            return def;
+        if constexpr (::std::is_same_v<Type, ::std::string>) {
+            return iter->second;
+        } else if constexpr (::std::is_same_v<Type, bool>) {
+            if (iter->second.empty() || iter->second == "1" || iter->second == "true" || iter->second == "yes")
+                return true;
+            if (iter->second == "0" || iter->second == "false" || iter->second == "no")
+                return false;
+            ::std::cerr << "Invalid value for option '--" << name << "': " << iter->second << ::std::endl;
+            throw Exception::ArgumentValue{};
+        } else {
+            Type res;
+            ::std::istringstream stream{iter->second};
+            if (!(stream >> res) || !(stream >> ::std::ws).eof()) {
+                ::std::cerr << "Invalid value for option '--" << name << "': " << iter->second << ::std::endl;
+                throw Exception::ArgumentValue{};
+            }
+            return res;
+        }
+    }
+    /** Check that every given option has been queried, throw 'Exception::ArgumentUnknown' otherwise.
+    **/
+    void check() const {
+        for (auto&& option: options) {
+            if (queried.count(option.first) == 0) {
+                ::std::cerr << "Unknown option '--" << option.first << "'" << ::std::endl;
+                throw Exception::ArgumentUnknown{};
+            }
+        }
+    }
+};
+
 /** Time accounting class.
 **/
 class Chrono final {
@@ -199,6 +298,136 @@ public:
     }
 };
 
+/** Cycle-counter time accounting class, cheaper to read than 'Chrono' for fine-grained (e.g. per-transaction) timing.
+ * Reads the invariant time-stamp counter on x86 and the virtual counter on AArch64, scaled to nanoseconds by a
+ * one-time calibration against the monotonic clock; falls back on the monotonic clock otherwise.
+**/
+class CycleChrono final {
+public:
+    using Tick = Chrono::Tick; // Tick class (always 1 tick = 1 ns)
+private:
+    /** Counter calibration class.
+    **/
+    struct Calibration {
+        bool   counter; // Whether the cycle counter is used, otherwise the monotonic clock is
+        double scale;   // Nanoseconds per counter increment
+    };
+    /** Read the monotonic clock.
+     * @return Monotonic time (in ns)
+    **/
+    static uint64_t monotonic() noexcept {
+        struct ::timespec buf;
+        ::clock_gettime(CLOCK_MONOTONIC, &buf);
+        return static_cast<uint64_t>(buf.tv_nsec) + static_cast<uint64_t>(buf.tv_sec) * 1000000000ul;
+    }
+    /** Read the cycle counter, ordered after the preceding instructions.
+     * @return Counter value (0 if there is no supported counter)
+    **/
+    static uint64_t counter() noexcept {
+#if defined(__i386__) || defined(__x86_64__)
+        unsigned int aux;
+        return __rdtscp(&aux);
+#elif defined(__aarch64__)
+        uint64_t res;
+        asm volatile("isb; mrs %0, cntvct_el0" : "=r"(res) :: "memory");
+        return res;
+#else
+        return 0;
+#endif
+    }
+    /** Check whether the cycle counter ticks at a constant rate, across cores and power states.
+     * @return Whether the cycle counter can be used as a clock
+    **/
+    static bool invariant() noexcept {
+#if defined(__i386__) || defined(__x86_64__)
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 27))) // RDTSCP
+            return false;
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)); // Invariant TSC
+#elif defined(__aarch64__)
+        return true;
+#else
+        return false;
+#endif
+    }
+    /** Calibrate the cycle counter against the monotonic clock, once.
+     * @return Calibration
+    **/
+    static Calibration const& calibration() noexcept {
+        static Calibration const res = []() {
+            if (!invariant())
+                return Calibration{false, 1.};
+            auto const time  = monotonic();
+            auto const count = counter();
+            ::std::this_thread::sleep_for(::std::chrono::milliseconds{20});
+            auto const dtime  = monotonic() - time;
+            auto const dcount = counter() - count;
+            if (unlikely(dcount == 0 || dtime == 0))
+                return Calibration{false, 1.};
+            return Calibration{true, static_cast<double>(dtime) / static_cast<double>(dcount)};
+        }();
+        return res;
+    }
+    /** Read the clock.
+     * @return Current time (in ns, since an unspecified origin)
+    **/
+    static Tick now() noexcept {
+        auto&& calib = calibration();
+        if (likely(calib.counter))
+            return static_cast<Tick>(static_cast<double>(counter()) * calib.scale);
+        return monotonic();
+    }
+private:
+    Tick total; // Total tick counter
+    Tick local; // Segment tick counter
+public:
+    /** Tick constructor.
+     * @param tick Initial number of ticks (optional)
+    **/
+    CycleChrono(Tick tick = 0) noexcept: total{tick}, local{0} {}
+public:
+    /** Check whether the cycle counter is used, calibrating it if not done yet.
+     * @return Whether the cycle counter is used, otherwise the monotonic clock is
+    **/
+    static bool is_cycle_counter() noexcept {
+        return calibration().counter;
+    }
+    /** Get the calibrated frequency of the cycle counter, calibrating it if not done yet.
+     * @return Frequency (in GHz), 0 if the monotonic clock is used
+    **/
+    static double get_frequency() noexcept {
+        auto&& calib = calibration();
+        return calib.counter ? 1. / calib.scale : 0.;
+    }
+public:
+    /** Start measuring a time segment.
+    **/
+    void start() noexcept {
+        local = now();
+    }
+    /** Measure a time segment.
+    **/
+    auto delta() noexcept {
+        return now() - local;
+    }
+    /** Stop measuring a time segment, and add it to the total.
+    **/
+    void stop() noexcept {
+        total += delta();
+    }
+    /** Reset the total tick counter.
+    **/
+    void reset() noexcept {
+        total = 0;
+    }
+    /** Get the total tick counter.
+     * @return Total tick counter
+    **/
+    auto get_tick() const noexcept {
+        return total;
+    }
+};
+
 /** Atomic waitable latch class.
 **/
 class Latch final {
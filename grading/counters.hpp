@@ -0,0 +1,278 @@
+/**
+ * @file   counters.hpp
+ * @author Will Yu (?@epfl.ch)
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Per-thread hardware and operating system counters sampling, and CPU time accounting.
+**/
+
+#pragma once
+
+// External headers
+#include <cstdint>
+#include <cstring>
+#ifdef __linux__
+extern "C" {
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+#endif
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Per-thread performance counters class, counting the calling thread only.
+**/
+class PerfCounters final: private NonCopyable {
+public:
+    /** Counted event enum.
+    **/
+    enum Event: size_t {
+        cycles,           // CPU cycles
+        cache_misses,     // Cache misses (usually last-level, as defined by the CPU vendor)
+        llc_misses,       // Last-level cache read misses
+        branch_misses,    // Mispredicted branches
+        context_switches, // Context switches (software event)
+        nbevents
+    };
+    /** Get the name of an event.
+     * @param event Event to name
+     * @return Null-terminated event name
+    **/
+    static char const* name(size_t event) noexcept {
+        constexpr static char const* names[nbevents] = {"cycles", "cache misses", "LLC misses", "branch misses", "context switches"};
+        return names[event];
+    }
+    /** Counter values class, accumulable across threads and phases.
+    **/
+    class Sample final {
+    public:
+        uint64_t values[nbevents]; // Counter values (scaled when multiplexed)
+        bool     valid[nbevents];  // Whether each counter could be sampled
+    public:
+        /** Empty sample constructor.
+         * @param valid Initial validity of each counter
+        **/
+        Sample(bool valid = false) noexcept {
+            for (size_t i = 0; i < nbevents; ++i) {
+                this->values[i] = 0;
+                this->valid[i]  = valid;
+            }
+        }
+    public:
+        /** Accumulate another sample, a counter staying valid only if valid in both.
+         * @param other Sample to accumulate
+         * @return Current sample
+        **/
+        Sample& operator+=(Sample const& other) noexcept {
+            for (size_t i = 0; i < nbevents; ++i) {
+                values[i] += other.values[i];
+                valid[i]   = valid[i] && other.valid[i];
+            }
+            return *this;
+        }
+        /** Check whether at least one counter could be sampled.
+         * @return Whether at least one counter is valid
+        **/
+        bool any() const noexcept {
+            for (size_t i = 0; i < nbevents; ++i) {
+                if (valid[i])
+                    return true;
+            }
+            return false;
+        }
+    };
+private:
+    int fds[nbevents]; // File descriptor of each counter, -1 if unavailable
+    int hwleader;      // File descriptor of the hardware group leader, -1 if unavailable
+#ifdef __linux__
+private:
+    /** Open one counter for the calling thread, on any CPU.
+     * @param type   Event type
+     * @param config Event configuration
+     * @param leader Group leader file descriptor, -1 to create a new group
+     * @param user   Whether to count in user mode only
+     * @return File descriptor, -1 on failure
+    **/
+    static int open(uint32_t type, uint64_t config, int leader, bool user) noexcept {
+        struct ::perf_event_attr attr;
+        ::std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = type;
+        attr.config         = config;
+        attr.disabled       = (leader == -1 ? 1 : 0);
+        attr.exclude_kernel = (user ? 1 : 0);
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+    }
+    /** Open one counter, falling back to user mode only if not permitted to count in kernel mode.
+     * @param type   Event type
+     * @param config Event configuration
+     * @param leader Group leader file descriptor, -1 to create a new group
+     * @return File descriptor, -1 on failure
+    **/
+    static int open(uint32_t type, uint64_t config, int leader) noexcept {
+        auto res = open(type, config, leader, false);
+        if (res < 0)
+            res = open(type, config, leader, true);
+        return res;
+    }
+#endif
+public:
+    /** Opening constructor, unavailable counters (e.g. not permitted, or unsupported) are silently skipped.
+    **/
+    PerfCounters() noexcept: hwleader{-1} {
+        for (size_t i = 0; i < nbevents; ++i)
+            fds[i] = -1;
+#ifdef __linux__
+        hwleader = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (hwleader >= 0) {
+            fds[cycles]        = hwleader;
+            fds[cache_misses]  = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, hwleader);
+            fds[llc_misses]    = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), hwleader);
+            fds[branch_misses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, hwleader);
+        }
+        fds[context_switches] = open(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, -1, false); // Context switches are only seen in kernel mode
+#endif
+    }
+    /** Closing destructor.
+    **/
+    ~PerfCounters() noexcept {
+#ifdef __linux__
+        for (size_t i = 0; i < nbevents; ++i) {
+            if (fds[i] >= 0 && fds[i] != hwleader)
+                ::close(fds[i]);
+        }
+        if (hwleader >= 0)
+            ::close(hwleader);
+#endif
+    }
+public:
+    /** Reset and start counting.
+    **/
+    void start() noexcept {
+#ifdef __linux__
+        if (hwleader >= 0) {
+            ::ioctl(hwleader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(hwleader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        if (fds[context_switches] >= 0) {
+            ::ioctl(fds[context_switches], PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fds[context_switches], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    /** Stop counting, and read the counters.
+     * @return Sampled counters, scaled if the counters were multiplexed
+    **/
+    Sample stop() noexcept {
+        Sample res;
+#ifdef __linux__
+        if (hwleader >= 0)
+            ::ioctl(hwleader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (fds[context_switches] >= 0)
+            ::ioctl(fds[context_switches], PERF_EVENT_IOC_DISABLE, 0);
+        for (size_t i = 0; i < nbevents; ++i) {
+            if (fds[i] < 0)
+                continue;
+            uint64_t buf[3]; // Value, time enabled, time running
+            if (unlikely(::read(fds[i], buf, sizeof(buf)) != sizeof(buf)))
+                continue;
+            if (unlikely(buf[2] == 0 && buf[1] > 0)) // Never scheduled
+                continue;
+            if (buf[2] > 0 && buf[2] < buf[1]) { // Multiplexed, extrapolate
+                res.values[i] = static_cast<uint64_t>(static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]));
+            } else {
+                res.values[i] = buf[0];
+            }
+            res.valid[i] = true;
+        }
+#endif
+        return res;
+    }
+};
+
+/** Per-thread CPU time and context switches class, from the resource usage of the calling thread.
+**/
+class CpuUsage final {
+public:
+    /** Resource usage values class, accumulable across threads and phases.
+    **/
+    class Sample final {
+    public:
+        uint64_t user;        // CPU time in user mode (in ns)
+        uint64_t system;      // CPU time in kernel mode (in ns)
+        uint64_t voluntary;   // Voluntary context switches (e.g. blocking on a lock or sleeping)
+        uint64_t involuntary; // Involuntary context switches (i.e. preemptions)
+        bool     valid;       // Whether the usage could be sampled
+    public:
+        /** Empty sample constructor.
+         * @param valid Initial validity
+        **/
+        Sample(bool valid = false) noexcept: user{0}, system{0}, voluntary{0}, involuntary{0}, valid{valid} {}
+    public:
+        /** Accumulate another sample, staying valid only if valid in both.
+         * @param other Sample to accumulate
+         * @return Current sample
+        **/
+        Sample& operator+=(Sample const& other) noexcept {
+            user        += other.user;
+            system      += other.system;
+            voluntary   += other.voluntary;
+            involuntary += other.involuntary;
+            valid        = valid && other.valid;
+            return *this;
+        }
+        /** Compute the usage between an earlier sample and this one.
+         * @param since Earlier sample of the same thread
+         * @return Usage in between
+        **/
+        Sample operator-(Sample const& since) const noexcept {
+            Sample res{valid && since.valid};
+            res.user        = user - since.user;
+            res.system      = system - since.system;
+            res.voluntary   = voluntary - since.voluntary;
+            res.involuntary = involuntary - since.involuntary;
+            return res;
+        }
+    };
+public:
+    /** Sample the usage of the calling thread since its creation.
+     * @return Sampled usage, invalid if per-thread usage is unsupported
+    **/
+    static Sample sample() noexcept {
+        Sample res;
+#ifdef RUSAGE_THREAD
+        struct ::rusage usage;
+        if (likely(::getrusage(RUSAGE_THREAD, &usage) == 0)) {
+            res.user        = static_cast<uint64_t>(usage.ru_utime.tv_sec) * 1000000000ul + static_cast<uint64_t>(usage.ru_utime.tv_usec) * 1000ul;
+            res.system      = static_cast<uint64_t>(usage.ru_stime.tv_sec) * 1000000000ul + static_cast<uint64_t>(usage.ru_stime.tv_usec) * 1000ul;
+            res.voluntary   = static_cast<uint64_t>(usage.ru_nvcsw);
+            res.involuntary = static_cast<uint64_t>(usage.ru_nivcsw);
+            res.valid       = true;
+        }
+#endif
+        return res;
+    }
+};
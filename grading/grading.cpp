@@ -23,14 +23,22 @@
 
 // External headers
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <random>
 #include <variant>
 
 // Internal headers
 #include "common.hpp"
+#include "counters.hpp"
+#include "memory.hpp"
+#include "stats.hpp"
+#include "topology.hpp"
 #include "transactional.hpp"
 #include "workload.hpp"
 
@@ -70,8 +78,9 @@ public:
     /** Master trigger "synchronized" execution in all threads (instead of joining).
     **/
     void master_notify() noexcept {
-        status.store(Status::Wait, ::std::memory_order_relaxed);
+        runtime.reset();
         runtime.start();
+        status.store(Status::Wait, ::std::memory_order_release); // Synchronize-with workers reading the phase to run
     }
     /** Master trigger termination in all threads (instead of notifying).
     **/
@@ -101,7 +110,7 @@ public:
     **/
     bool worker_wait() noexcept {
         while (true) {
-            auto res = status.load(::std::memory_order_relaxed);
+            auto res = status.load(::std::memory_order_acquire); // Synchronize-with 'master_notify'
             if (res == Status::Wait)
                 break;
             if (res == Status::Quit)
@@ -120,6 +129,12 @@ public:
         } while (true);
         return true;
     }
+    /** [thread-safe] Worker get the time elapsed since the master triggered the current run.
+     * @return Elapsed time (in ns)
+    **/
+    Chrono::Tick worker_elapsed() noexcept {
+        return runtime.delta();
+    }
     /** Worker notify termination of its run.
      * @param error Error constant null-terminated string ('nullptr' for none)
     **/
@@ -138,113 +153,832 @@ public:
     }
 };
 
-/** Measure the arithmetic mean of the execution time of the given workload with the given transaction library.
- * @param workload     Workload instance to use
- * @param nbthreads    Number of concurrent threads to use
- * @param nbrepeats    Number of repetitions (keep the median)
- * @param seed         Seed to use for performance measurements
- * @param maxtick_init Timeout for (re)initialization ('Chrono::invalid_tick' for none)
- * @param maxtick_perf Timeout for performance measurements ('Chrono::invalid_tick' for none)
- * @param maxtick_chck Timeout for correctness check ('Chrono::invalid_tick' for none)
- * @return Error constant null-terminated string ('nullptr' for none), execution times (in ns) (undefined if inconsistency detected)
+/** Worker thread pool class, running the phases of any workload on the master's request.
 **/
-static auto measure(Workload& workload, unsigned int const nbthreads, unsigned int const nbrepeats, Seed seed, Chrono::Tick maxtick_init, Chrono::Tick maxtick_perf, Chrono::Tick maxtick_chck) {
-    ::std::vector<::std::thread> threads(nbthreads);
-    ::std::mutex  cerrlock;        // To avoid interleaving writes to 'cerr' in case more than one thread throw
-    Sync          sync{nbthreads}; // "As-synchronized-as-possible" starts so that threads interfere "as-much-as-possible"
-    
-    // We start nbthreads threads to measure performance.
-    for (unsigned int i = 0; i < nbthreads; ++i) { // Start threads
+class Pool final: private NonCopyable {
+public:
+    /** Workload phase enum.
+    **/
+    enum class Phase {
+        init,    // Shared memory (re)initialization
+        perf,    // Performance measurement
+        check,   // Correctness check
+        prepare  // Untimed preparation of the next performance measurement
+    };
+    /** Phase result class.
+    **/
+    struct Result {
+        char const*          error;    // Error constant null-terminated string ('nullptr' for none)
+        Chrono::Tick         time;     // Execution time (in ns) (undefined on error)
+        PerfCounters::Sample counters; // Counters summed over the threads (all invalid if not sampled)
+        CpuUsage::Sample     usage;    // CPU time and context switches summed over the threads
+        TransactionCounters transactions; // Transaction outcomes summed over the threads
+        ::std::vector<uint64_t>     commits;  // Committed transactions of each thread that did work
+        ::std::vector<Chrono::Tick> finishes; // Completion time of each thread, since the start of the phase (in ns)
+    };
+private:
+    bool const                 counters; // Whether to sample the performance counters
+    ::std::vector<::std::thread> threads; // Worker threads
+    ::std::mutex               cerrlock; // To avoid interleaving writes to 'cerr' in case more than one thread throw
+    ::std::mutex             samplelock; // To accumulate the counters sampled and the transactions counted by each thread
+    Sync                           sync; // "As-synchronized-as-possible" starts so that threads interfere "as-much-as-possible"
+    Workload const*            workload; // Workload of the current phase
+    Phase                         phase; // Current phase
+    Seed                           seed; // Seed of the current phase (each worker adds its unique ID)
+    PerfCounters::Sample         sample; // Counters of the current phase
+    CpuUsage::Sample              usage; // CPU time and context switches of the current phase
+    TransactionCounters    transactions; // Transaction outcomes of the current phase
+    ::std::vector<uint64_t>     commits; // Committed transactions of each thread that did work in the current phase
+    ::std::vector<Chrono::Tick> finishes; // Completion time of each thread in the current phase
+    bool                          stuck; // Whether a phase overran, so the threads cannot be joined
+private:
+    /** Worker thread entry point.
+     * @param uid Worker unique ID
+    **/
+    void worker(Uid uid) {
+        ::std::optional<PerfCounters> perf;
+        if (counters)
+            perf.emplace();
+        // This is the workload that all threads run simulataneously, one phase at a time.
+        // Each phase is specified in workload.hpp.
+        // Threads are synchronized between each phase so that they run with a lot of concurrency.
+        while (sync.worker_wait()) {
+            char const* error;
+            try {
+                transaction_counters = TransactionCounters{0, 0, 0};
+                auto const since = CpuUsage::sample();
+                if (perf)
+                    perf->start();
+                switch (phase) {
+                case Phase::init:
+                    error = workload->init();
+                    break;
+                case Phase::perf:
+                    error = workload->run(uid, seed + uid);
+                    break;
+                case Phase::prepare:
+                    error = workload->prepare(uid, seed + uid);
+                    break;
+                default: // Phase::check
+                    error = workload->check(uid, ::std::random_device{}()); // Random seed is wanted here
+                    break;
+                }
+                { // Accumulate the counters of the phase, before notifying the master
+                    auto res = perf ? perf->stop() : PerfCounters::Sample{};
+                    auto used = CpuUsage::sample() - since;
+                    ::std::unique_lock<decltype(samplelock)> guard{samplelock};
+                    if (perf)
+                        sample += res;
+                    usage += used;
+                    transactions += transaction_counters;
+                }
+                commits[uid]  = transaction_counters.begun - transaction_counters.aborted - transaction_counters.idle; // Idle polls would measure spinning, not work
+                finishes[uid] = sync.worker_elapsed();
+            } catch (::std::exception const& err) {
+                error = "Internal worker exception(s)"; // Exception in 'Workload::*', since 'Sync::worker_*' do not throw
+                { // Print the error
+                    ::std::unique_lock<decltype(cerrlock)> guard{cerrlock};
+                    ::std::cerr << "⎪⎧ *** EXCEPTION ***" << ::std::endl << "⎪⎩ " << err.what() << ::std::endl;
+                }
+            }
+            sync.worker_notify(error);
+        }
+    }
+public:
+    /** Spawning constructor.
+     * @param nbthreads Number of concurrent threads to use
+     * @param placement Logical CPU to pin each thread on (empty for no pinning)
+     * @param counters  Whether to sample the performance counters of each phase
+    **/
+    Pool(unsigned int nbthreads, ::std::vector<int> const& placement, bool counters): counters{counters}, threads(nbthreads), sync{nbthreads}, workload{nullptr}, phase{Phase::init}, seed{0}, commits(nbthreads), finishes(nbthreads), stuck{false} {
+        for (unsigned int i = 0; i < nbthreads; ++i) {
+            try {
+                threads[i] = ::std::thread{[this](Uid uid) { worker(uid); }, i};
+                if (!placement.empty())
+                    Topology::pin(threads[i], placement[i]);
+            } catch (...) {
+                sync.master_join();
+                for (unsigned int j = 0; j <= i; ++j) { // Detach threads to avoid termination due to attached thread going out of scope
+                    if (threads[j].joinable())
+                        threads[j].detach();
+                }
+                throw;
+            }
+        }
+    }
+    /** Joining destructor.
+    **/
+    ~Pool() noexcept {
+        sync.master_join();
+        for (auto&& thread: threads) {
+            if (unlikely(stuck)) { // Detach threads to avoid termination due to attached thread going out of scope
+                thread.detach();
+            } else {
+                thread.join();
+            }
+        }
+    }
+public:
+    /** Run one phase of the given workload in all the threads.
+     * @param workload Workload instance to use
+     * @param phase    Phase to run
+     * @param seed     Seed to use for performance measurements (each worker adds its unique ID)
+     * @param maxtick  Timeout ('Chrono::invalid_tick' for none), throws 'Exception::BoundedOverrun' on overtime
+     * @return Phase result
+    **/
+    Result run(Workload const& workload, Phase phase, Seed seed, Chrono::Tick maxtick) {
+        this->workload = &workload;
+        this->phase    = phase;
+        this->seed     = seed;
+        sample = PerfCounters::Sample{counters};
+        usage  = CpuUsage::Sample{true};
+        transactions = TransactionCounters{0, 0, 0};
+        sync.master_notify(); // We tell workers to start working.
         try {
-            threads[i] = ::std::thread{[&](unsigned int i) {
-                // This is the workload that all threads run simulataneously.
-                // It is devided into a series of small tests. Each test is specified in workload.hpp.
-                // Threads are synchronized between each test so that they run with a lot of concurrency.
-                try {
-                    // 1. Initialization
-                    if (!sync.worker_wait()) return; // Sync. of threads
-                    sync.worker_notify(workload.init()); // Runs the test and tells the master about errors
+            auto res = sync.master_wait(maxtick); // If running the student's version, it will timeout if way slower than the reference.
+            if (unlikely(::std::holds_alternative<char const*>(res))) // If an error happened (violation or exception)
+                return Result{::std::get<char const*>(res), Chrono::invalid_tick, sample, usage, transactions, commits, finishes};
+            return Result{nullptr, ::std::get<Chrono>(res).get_tick(), sample, usage, transactions, commits, finishes};
+        } catch (...) {
+            stuck = true;
+            throw;
+        }
+    }
+};
 
-                    // 2. Performance measurements
-                    for (unsigned int count = 0; count < nbrepeats; ++count) {
-                        if (!sync.worker_wait()) return;
-                        sync.worker_notify(workload.run(i, seed + nbthreads * count + i));
-                    }
+/** Per-thread fairness of one repetition class.
+**/
+struct Fairness {
+    uint64_t     min_commits; // Fewest transactions committed by a thread (idle ones excluded)
+    uint64_t     max_commits; // Most transactions committed by a thread (idle ones excluded)
+    Chrono::Tick min_finish;  // Earliest thread completion time (in ns)
+    Chrono::Tick max_finish;  // Latest thread completion time (in ns)
+    double       jain_commits; // Jain's index of the committed transaction counts
+    double       jain_rates;   // Jain's index of the per-thread commit rates (committed transactions over completion time)
+    /** Summarize the per-thread outcomes of one phase.
+     * @param commits  Committed transactions of each thread, idle ones excluded
+     * @param finishes Completion time of each thread
+     * @return Fairness of the phase
+    **/
+    static Fairness measure(::std::vector<uint64_t> const& commits, ::std::vector<Chrono::Tick> const& finishes) {
+        ::std::vector<double> counts;
+        ::std::vector<double> rates;
+        for (size_t i = 0; i < commits.size(); ++i) {
+            counts.push_back(static_cast<double>(commits[i]));
+            rates.push_back(finishes[i] > 0 ? static_cast<double>(commits[i]) / static_cast<double>(finishes[i]) : 0.);
+        }
+        return Fairness{*::std::min_element(commits.begin(), commits.end()), *::std::max_element(commits.begin(), commits.end()),
+            *::std::min_element(finishes.begin(), finishes.end()), *::std::max_element(finishes.begin(), finishes.end()),
+            Stats::jain(counts), Stats::jain(rates)};
+    }
+};
 
-                    // 3. Correctness check
-                    if (!sync.worker_wait()) return;
-                    sync.worker_notify(workload.check(i, std::random_device{}())); // Random seed is wanted here
+/** Measurements of one library class.
+**/
+struct Evaluation {
+    char const*                             path;      // Path to the library
+    ::std::unique_ptr<TransactionalLibrary> tl;        // Loaded library
+    ::std::unique_ptr<Workload>             workload;  // Workload instance (shared memory lifetime bound to workload, destroyed before the library)
+    Chrono::Tick                            time_init; // Initialization time (in ns)
+    ::std::vector<double>                   times;     // Execution time of each repetition (in ns)
+    ::std::vector<double>                   preps;     // Untimed preparation time of each repetition (in ns)
+    Chrono::Tick                            time_chck; // Correctness check time (in ns)
+    ::std::array<PerfCounters::Sample, 3>   samples;   // Counters of the initialization, all the repetitions and the check
+    ::std::array<CpuUsage::Sample, 3>       usages;    // CPU time and context switches of the initialization, all the repetitions and the check
+    TransactionCounters                     transactions; // Transaction outcomes of all the repetitions
+    ::std::vector<Fairness>                 fairness;  // Per-thread fairness of each repetition
+    Memory::Size                            memory;    // Resident memory growth over the workload construction and the library's own phases (in bytes, 'Memory::invalid_size' if unavailable)
+    Memory::Size                            memory_peak; // Peak of the above during the library's own phases (in bytes, 'Memory::invalid_size' if unavailable)
+    char const*                             error;     // Error constant null-terminated string ('nullptr' for none)
+};
 
-                    // Synchronized quit
-                    if (!sync.worker_wait()) return;
-                    throw Exception::Unreachable{"unexpected worker iteration after checks"};
-                } catch (::std::exception const& err) {
-                    sync.worker_notify("Internal worker exception(s)"); // Exception post-'Sync::worker_wait' (i.e. in 'Workload::run' or 'Workload::check'), since 'Sync::worker_*' do not throw
-                    { // Print the error
-                        ::std::unique_lock<decltype(cerrlock)> guard{cerrlock};
-                        ::std::cerr << "⎪⎧ *** EXCEPTION ***" << ::std::endl << "⎪⎩ " << err.what() << ::std::endl;
-                    }
-                    return;
-                }
-            }, i};
-        } catch (...) {
-            for (unsigned int j = 0; j < i; ++j) // Detach threads to avoid termination due to attached thread going out of scope
-                threads[j].detach();
+/** Print sampled counters, divided by a given number of events.
+ * @param label   Null-terminated label
+ * @param sample  Sampled counters
+ * @param divisor Number of events (e.g. transactions) the counters are divided by
+**/
+static void print_counters(char const* label, PerfCounters::Sample const& sample, double divisor) {
+    ::std::cout << "⎪ " << label;
+    if (unlikely(!sample.any())) {
+        ::std::cout << "<unavailable>" << ::std::endl;
+        return;
+    }
+    auto first = true;
+    for (size_t i = 0; i < PerfCounters::nbevents; ++i) {
+        if (!sample.valid[i])
+            continue;
+        ::std::cout << (first ? "" : ", ") << (static_cast<double>(sample.values[i]) / divisor) << " " << PerfCounters::name(i);
+        first = false;
+    }
+    ::std::cout << ::std::endl;
+}
+
+/** Selected workload class, built from the command line options.
+**/
+struct Scenario {
+    ::std::vector<::std::pair<::std::string, ::std::string>> params; // Workload parameters to print, as (label, value)
+    ::std::function<::std::unique_ptr<Workload>(TransactionalLibrary const&)> make; // Workload factory, for one library
+    /** Record a parameter to print.
+     * @param label Parameter label
+     * @param value Parameter value
+    **/
+    template<class Type> void param(char const* label, Type const& value) {
+        ::std::ostringstream stream;
+        stream << value;
+        params.emplace_back(label, stream.str());
+    }
+};
+
+/** Select the workload and parse its parameters, throw 'Exception::ArgumentValue' if unknown.
+ * @param args       Command line arguments
+ * @param nbsizing   Number of worker threads the shared data is sized for (accounts, key ranges)
+ * @param nbworkers  Number of worker threads
+ * @param nbtxperwrk Number of transactions per worker
+ * @return Selected workload
+**/
+static Scenario select_workload(Arguments const& args, size_t nbsizing, size_t nbworkers, size_t nbtxperwrk) {
+    Scenario res;
+    auto const name = args.get<::std::string>("workload", "bank");
+    auto const keys = KeyDistribution::parse(args.get<::std::string>("keys", "uniform"));
+    res.param("Workload", name);
+    if (name == "bank") {
+        auto const nbaccounts    = 32 * nbsizing;
+        auto const expnbaccounts = 256 * nbsizing;
+        auto const init_balance  = 100ul;
+        auto const preset        = args.get<::std::string>("preset", "default");
+        auto prob_long  = 0.5f;  // Share of long read-only scans
+        auto prob_alloc = 0.01f; // Share of account (de)allocations among the other transactions
+        auto read_only  = 0.f;   // Target share of read-only transactions (scans included), 0 for no short read-only transaction
+        if (preset == "read-heavy") {
+            prob_long = 0.05f;
+            read_only = 0.95f;
+        } else if (preset == "balanced") {
+            prob_long = 0.05f;
+            read_only = 0.5f;
+        } else if (preset == "write-heavy") {
+            prob_long = 0.05f;
+        } else if (preset == "scan") {
+            prob_long = 1.f;
+        } else if (unlikely(preset != "default")) {
+            throw Exception::ArgumentValue{"unknown bank preset (expected 'default', 'read-heavy', 'balanced', 'write-heavy' or 'scan')"};
+        }
+        auto const prob_read = read_only > prob_long ? (read_only - prob_long) / ((1.f - prob_long) * (1.f - prob_alloc)) : 0.f;
+        res.param("Mix preset", preset);
+        res.param("Initial #accounts", nbaccounts);
+        res.param("Expected #accounts", expnbaccounts);
+        res.param("Initial balance", init_balance);
+        res.param("Long TX probability", prob_long);
+        res.param("Allocation TX prob.", prob_alloc);
+        res.param("Read-only TX share", ::std::to_string(static_cast<int>(100.f * (prob_long + (1.f - prob_long) * (1.f - prob_alloc) * prob_read) + .5f)) + " %");
+        res.param("Account selection", keys);
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadBank>(tl, nbworkers, nbtxperwrk, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc, prob_read, keys);
+        };
+    } else if (name == "hashmap") {
+        auto const nbkeys      = args.get<size_t>("range", 1024 * nbsizing);
+        auto const prob_update = args.get<float>("updates", 0.1f);
+        if (unlikely(nbkeys == 0 || !(prob_update >= 0.f && prob_update <= 1.f)))
+            throw Exception::ArgumentValue{"invalid hash map parameters"};
+        res.param("#keys", nbkeys);
+        res.param("Update TX prob.", prob_update);
+        res.param("Key selection", keys);
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadHashMap>(tl, nbworkers, nbtxperwrk, nbkeys, prob_update, keys);
+        };
+    } else if (name == "list" || name == "skiplist") {
+        auto const list        = name == "list";
+        auto const nbkeys      = args.get<size_t>("range", list ? 512 : 1024 * nbsizing);
+        auto const nblevels    = list ? 1 : args.get<size_t>("levels", [&]() {
+            size_t res = 1;
+            while (res < WorkloadSkipList::max_levels && (size_t{1} << res) < nbkeys)
+                ++res;
+            return res;
+        }());
+        auto const prob_update = args.get<float>("updates", 0.1f);
+        auto const mode        = NodePool::parse(args.get<::std::string>("nodes", "pool"));
+        if (unlikely(nbkeys == 0 || nblevels == 0 || nblevels > WorkloadSkipList::max_levels || !(prob_update >= 0.f && prob_update <= 1.f)))
+            throw Exception::ArgumentValue{"invalid list parameters"};
+        res.param("#keys", nbkeys);
+        if (!list)
+            res.param("#levels", nblevels);
+        res.param("Update TX prob.", prob_update);
+        res.param("Key selection", keys);
+        res.param("Node allocation", NodePool::name(mode));
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadSkipList>(tl, nbworkers, nbtxperwrk, nbkeys, nblevels, prob_update, keys, mode);
+        };
+    } else if (name == "rbtree") {
+        auto const nbkeys      = args.get<size_t>("range", 1024 * nbsizing);
+        auto const prob_update = args.get<float>("updates", 0.1f);
+        auto const mode        = NodePool::parse(args.get<::std::string>("nodes", "pool"));
+        if (unlikely(nbkeys == 0 || !(prob_update >= 0.f && prob_update <= 1.f)))
+            throw Exception::ArgumentValue{"invalid red-black tree parameters"};
+        res.param("#keys", nbkeys);
+        res.param("Update TX prob.", prob_update);
+        res.param("Key selection", keys);
+        res.param("Node allocation", NodePool::name(mode));
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadRBTree>(tl, nbworkers, nbtxperwrk, nbkeys, prob_update, keys, mode);
+        };
+    } else if (name == "vacation") {
+        auto const preset = args.get<::std::string>("preset", "low");
+        if (unlikely(preset != "low" && preset != "high"))
+            throw Exception::ArgumentValue{"unknown vacation preset (expected 'low' or 'high')"};
+        auto const high          = preset == "high"; // STAMP's "vacation-high" parameters (-n4 -q60 -u90), otherwise "vacation-low" ones (-n2 -q90 -u98)
+        auto const nbrelations   = args.get<size_t>("relations", 4096);
+        auto const nbqueries     = args.get<size_t>("queries", high ? 4 : 2);
+        auto const percent_query = args.get<unsigned>("query-range", high ? 60 : 90);
+        auto const percent_user  = args.get<unsigned>("user", high ? 90 : 98);
+        auto const mode          = NodePool::parse(args.get<::std::string>("nodes", "pool"));
+        auto const query_range   = nbrelations * percent_query / 100;
+        if (unlikely(nbqueries == 0 || query_range == 0 || percent_query > 100 || percent_user > 100))
+            throw Exception::ArgumentValue{"invalid vacation parameters"};
+        res.param("Contention preset", preset);
+        res.param("#relations", nbrelations);
+        res.param("#queries per TX", nbqueries);
+        res.param("Queried relations", ::std::to_string(percent_query) + " %");
+        res.param("Reservation TX", ::std::to_string(percent_user) + " %");
+        res.param("Record allocation", NodePool::name(mode));
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadVacation>(tl, nbworkers, nbtxperwrk, nbrelations, nbqueries, query_range, percent_user, mode);
+        };
+    } else if (name == "labyrinth") {
+        auto const side    = args.get<size_t>("grid", 128);
+        auto const region  = args.get<size_t>("region", 16);
+        auto const nbpaths = args.get<size_t>("paths", 8);
+        if (unlikely(region < 2 || region > side || nbpaths == 0))
+            throw Exception::ArgumentValue{"invalid labyrinth parameters (the region must fit in the grid)"};
+        res.param("Grid size", ::std::to_string(side) + " x " + ::std::to_string(side));
+        res.param("Region read per TX", ::std::to_string(region) + " x " + ::std::to_string(region));
+        res.param("Paths per worker", nbpaths);
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadLabyrinth>(tl, nbworkers, nbtxperwrk, side, region, nbpaths);
+        };
+    } else if (name == "blocks") {
+        auto const record_size = args.get<size_t>("record-size", 4096);
+        auto const chunk_size  = args.get<size_t>("chunk-size", record_size);
+        auto const nbrecords   = args.get<size_t>("records", 64);
+        auto const prob_update = args.get<float>("updates", 0.1f);
+        if (unlikely(nbrecords == 0 || chunk_size == 0 || chunk_size % sizeof(WorkloadBlocks::Word) != 0 || record_size % chunk_size != 0 || !(prob_update >= 0.f && prob_update <= 1.f)))
+            throw Exception::ArgumentValue{"invalid large-block parameters (the access size must be a multiple of the word size, dividing the record size)"};
+        res.param("#records", nbrecords);
+        res.param("Record size", ::std::to_string(record_size) + " B");
+        res.param("Access size", ::std::to_string(chunk_size) + " B");
+        res.param("Update TX prob.", prob_update);
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadBlocks>(tl, nbtxperwrk, nbrecords, record_size / sizeof(WorkloadBlocks::Word), chunk_size / sizeof(WorkloadBlocks::Word), prob_update);
+        };
+    } else if (name == "churn") {
+        auto const nblive   = args.get<size_t>("live", 32);
+        auto const min_size = args.get<size_t>("min-size", WorkloadChurn::header * sizeof(WorkloadChurn::Word));
+        auto const max_size = args.get<size_t>("max-size", 4096);
+        if (unlikely(nblive == 0 || min_size < WorkloadChurn::header * sizeof(WorkloadChurn::Word) || min_size > max_size || min_size % sizeof(WorkloadChurn::Word) != 0 || max_size % sizeof(WorkloadChurn::Word) != 0))
+            throw Exception::ArgumentValue{"invalid allocation churn parameters (sizes must be multiples of the word size, of at least 3 words)"};
+        res.param("Max. live segments", nblive);
+        res.param("Segment size", ::std::to_string(min_size) + " to " + ::std::to_string(max_size) + " B");
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadChurn>(tl, nbworkers, nbtxperwrk, nblive, min_size, max_size);
+        };
+    } else if (name == "replay") {
+        auto const path  = args.get<::std::string>("trace", "tm.trace");
+        auto const pace  = args.get<bool>("trace-pace", false);
+        auto const trace = ::std::make_shared<Trace const>(path);
+        if (unlikely(trace->nbtxs == 0))
+            throw Exception::ArgumentValue{"the trace holds no committed transaction"};
+        res.param("Trace file", path);
+        res.param("#recorded threads", trace->threads.size());
+        res.param("#recorded TX", ::std::to_string(trace->nbtxs) + " (" + ::std::to_string(trace->nbaccesses) + " accesses, " + ::std::to_string(trace->nbdropped) + " dropped)");
+        res.param("#recorded segments", trace->segments.size());
+        res.param("Replay pace", pace ? "recorded" : "as fast as possible");
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadReplay>(tl, nbworkers, trace, pace);
+        };
+    } else if (name == "queue") {
+        auto const nbproducers = args.get<size_t>("producers", ::std::max<size_t>(nbworkers / 2, 1));
+        auto const capacity    = args.get<size_t>("capacity", 64);
+        if (unlikely(nbproducers == 0 || nbproducers >= nbworkers || capacity == 0))
+            throw Exception::ArgumentValue{"the queue workload requires at least one producer and one consumer thread, and a non-empty ring"};
+        res.param("#producers", nbproducers);
+        res.param("#consumers", nbworkers - nbproducers);
+        res.param("Queue capacity", capacity);
+        res.make = [=](TransactionalLibrary const& tl) {
+            return ::std::make_unique<WorkloadQueue>(tl, nbworkers, nbtxperwrk, nbproducers, capacity);
+        };
+    } else {
+        throw Exception::ArgumentValue{"unknown workload"};
+    }
+    return res;
+}
+
+/** Run parameters common to every evaluation.
+**/
+struct Settings {
+    Arguments const& args;        // Command line arguments (seed, then the library paths)
+    Topology const&  topology;    // CPU topology
+    Topology::Policy pinning;     // Worker thread pinning policy
+    bool             counters;    // Whether to sample the performance counters of each phase
+    size_t           nbrepeats;   // Number of repetitions per library
+    bool             interleaved; // Whether the repetitions of the libraries are interleaved
+    double           confidence;  // Confidence level of the bootstrap intervals
+    size_t           nbresamples; // Number of bootstrap resamples
+    Seed             seed;        // Seed value
+    Chrono::Tick     slow_factor; // Timeout of a tested library, in multiples of the reference's duration, 0 for none
+    double           rate;        // Per-worker open-loop arrival rate (in TX/s), 0 for closed-loop runs
+    bool             harness;     // Whether to report the harness work moved out of the measured time
+    ::std::string    floor_path;  // Path to the null library measuring the floor (empty for none)
+};
+
+/** Floor measurement class.
+**/
+struct Floor {
+    char const* error; // Error of the runs on the null library, 'nullptr' for none
+    double      time;  // Median duration of a repetition (in ns), 0 if the runs cannot be serialized
+    int         cpu;   // Logical CPU the runs were pinned on, negative if unpinned
+};
+
+/** Measure the cost of the workload and harness alone, running the workers' runs of each repetition one after the other on a single thread, on a library without synchronization.
+ * @param scenario  Workload, selected with the parameters of the evaluated runs
+ * @param path      Path to the null library
+ * @param nbworkers Number of workers whose runs make up a repetition
+ * @param cpu       Logical CPU to pin the measuring thread on
+ * @param required  Whether pinning was requested, a failure to pin then throwing 'Exception::TopologyPin' instead of measuring unpinned
+ * @param nbrepeats Number of repetitions
+ * @param seed      Seed value, each repetition using the seeds of the evaluated one
+ * @return Floor measurement
+**/
+static Floor measure_floor(Scenario const& scenario, ::std::string const& path, size_t nbworkers, int cpu, bool required, size_t nbrepeats, Seed seed) {
+    TransactionalLibrary const tl{path.c_str()};
+    auto const workload = scenario.make(tl);
+    if (!workload->can_run_serially())
+        return Floor{nullptr, 0., -1};
+    ::std::vector<double> times;
+    char const* error = nullptr;
+    bool cancelled = false;
+    Latch pinned; // Raised once the thread is pinned (or left unpinned), or cancelled
+    ::std::thread thread{[&]() {
+        pinned.wait(Chrono::invalid_tick);
+        if (cancelled)
+            return;
+        try {
+            error = workload->init();
+            for (size_t count = 0; !error && count < nbrepeats; ++count) {
+                auto const base = seed + nbworkers * count;
+                for (size_t uid = 0; !error && uid < nbworkers; ++uid) // Untimed, as in the evaluated repetitions
+                    error = workload->prepare(uid, base + uid);
+                Chrono clock;
+                clock.start();
+                for (size_t uid = 0; !error && uid < nbworkers; ++uid)
+                    error = workload->run(uid, base + uid);
+                times.push_back(static_cast<double>(clock.delta()));
+            }
+        } catch (::std::exception const& err) {
+            error = "Internal floor exception";
+            ::std::cerr << "⎪⎧ *** EXCEPTION ***" << ::std::endl << "⎪⎩ " << err.what() << ::std::endl;
+        }
+    }};
+    try {
+        Topology::pin(thread, cpu);
+    } catch (Exception::TopologyPin const&) { // E.g. unsupported on this platform, only fatal if pinning was requested
+        if (required) {
+            cancelled = true;
+            pinned.raise();
+            thread.join();
             throw;
         }
+        cpu = -1;
     }
+    pinned.raise();
+    thread.join();
+    if (unlikely(error))
+        return Floor{error, 0., cpu};
+    return Floor{nullptr, Stats::median(times), cpu};
+}
 
-    // This is the master that synchronizes the worker threads.
-    // It basically triggers each step seen above.
-    // After all tests succeed, it returns the time it took to run each test.
-    // It returns early in case of a failure.
+/** Evaluate every library at one number of worker threads, printing the run parameters and the results.
+ * @param settings    Common run parameters
+ * @param nbworkers   Number of worker threads
+ * @param nbsizing    Number of worker threads the shared data is sized for
+ * @param throughputs Committed TX throughput of each library (in TX/s, 0 if not measured), filled
+ * @return Program return code
+**/
+static int evaluate(Settings const& settings, size_t nbworkers, size_t nbsizing, ::std::vector<double>& throughputs) {
+    auto&& args            = settings.args;
+    auto&& topology        = settings.topology;
+    auto const pinning     = settings.pinning;
+    auto const placement   = topology.placement(pinning, nbworkers);
+    auto const counters    = settings.counters;
+    auto const nbtxperwrk  = 200000ul / nbworkers;
+    auto const scenario    = select_workload(args, nbsizing, nbworkers, nbtxperwrk);
+    auto const nbrepeats   = settings.nbrepeats;
+    auto const interleaved = settings.interleaved;
+    auto const confidence  = settings.confidence;
+    auto const nbresamples = settings.nbresamples;
+    auto const seed        = settings.seed;
+    auto const clk_res     = Chrono::get_resolution();
+    auto const slow_factor = settings.slow_factor;
+    auto const rate        = settings.rate;
+    auto const harness     = settings.harness;
+    auto const floor       = settings.floor_path.empty() ? Floor{nullptr, 0., -1} : measure_floor(scenario, settings.floor_path, nbworkers, placement.empty() ? topology.placement(Topology::Policy::compact, 1)[0] : placement[0], !placement.empty(), nbrepeats, seed); // Worker time of one repetition without synchronization
+    throughputs.assign(args.size() - 1, 0.);
+
+    // Print run parameters
+    ::std::cout << "⎧ #worker threads:     " << nbworkers;
+    if (nbsizing != nbworkers)
+        ::std::cout << " (data sized for " << nbsizing << ")";
+    ::std::cout << ::std::endl;
+    ::std::cout << "⎪ #TX per worker:      " << nbtxperwrk << ::std::endl;
+    ::std::cout << "⎪ #repetitions:        " << nbrepeats << (interleaved ? " (interleaved)" : " (sequential)") << ::std::endl;
+    for (auto&& param: scenario.params)
+        ::std::cout << "⎪ " << param.first << ":" << ::std::string(param.first.size() < 20 ? 20 - param.first.size() : 1, ' ') << param.second << ::std::endl;
+    ::std::cout << "⎪ Arrivals:            ";
+    if (rate > 0.) {
+        ::std::cout << "open loop, Poisson at " << rate << " TX/s per worker (" << (rate * static_cast<double>(nbworkers)) << " TX/s offered)" << ::std::endl;
+    } else {
+        ::std::cout << "closed loop" << ::std::endl;
+    }
+    ::std::cout << "⎪ Slow trigger factor: ";
+    if (slow_factor == 0) {
+        ::std::cout << "<none>" << ::std::endl;
+    } else {
+        ::std::cout << slow_factor << ::std::endl;
+    }
+    ::std::cout << "⎪ Clock resolution:    ";
+    if (unlikely(clk_res == Chrono::invalid_tick)) {
+        ::std::cout << "<unknown>" << ::std::endl;
+    } else {
+        ::std::cout << clk_res << " ns" << ::std::endl;
+    }
+    if (!settings.floor_path.empty()) {
+        ::std::cout << "⎪ Floor library:       '" << settings.floor_path << "', ";
+        if (unlikely(floor.error)) {
+            ::std::cout << "<failed>" << ::std::endl;
+        } else if (floor.time > 0.) {
+            ::std::cout << (floor.time / 1000000.) << " ms per repetition, the " << nbworkers << " worker run(s) in turn ";
+            if (floor.cpu >= 0) {
+                ::std::cout << "on CPU " << floor.cpu << ::std::endl;
+            } else {
+                ::std::cout << "on one unpinned thread" << ::std::endl;
+            }
+        } else {
+            ::std::cout << "<unavailable, the worker runs cannot be serialized>" << ::std::endl;
+        }
+    }
+    ::std::cout << "⎪ Operation clock:     ";
+    if (CycleChrono::is_cycle_counter()) {
+        ::std::cout << "cycle counter, " << CycleChrono::get_frequency() << " GHz" << ::std::endl;
+    } else {
+        ::std::cout << "monotonic clock" << ::std::endl;
+    }
+    ::std::cout << "⎪ CPU topology:        " << topology.get_nbpackages() << " package(s), " << topology.get_nbcores() << " core(s), " << topology.get_nbcpus() << " logical CPU(s)" << ::std::endl;
+    ::std::cout << "⎪ Thread pinning:      " << Topology::name(pinning);
+    if (!placement.empty()) {
+        ::std::cout << " (CPU";
+        for (auto cpu: placement)
+            ::std::cout << " " << cpu;
+        ::std::cout << ")";
+    }
+    ::std::cout << ::std::endl;
+    ::std::cout << "⎪ Confidence level:    " << confidence << " (" << nbresamples << " bootstrap resamples)" << ::std::endl;
+    ::std::cout << "⎩ Seed value:          " << seed << ::std::endl;
+    if (unlikely(floor.error)) { // The workload failed on its own, so would any library
+        ::std::cout << "⎧ Measuring the floor on '" << settings.floor_path << "'..." << ::std::endl;
+        ::std::cout << "⎩ " << floor.error << ::std::endl;
+        return 1;
+    }
+    // Load every library and build its workload, the reference first
+    ::std::vector<Evaluation> evals(args.size() - 1);
+    for (size_t i = 0; i < evals.size(); ++i) {
+        auto&& eval = evals[i];
+        eval.path     = args[i + 1];
+        eval.tl       = ::std::make_unique<TransactionalLibrary>(eval.path);
+        auto const before = Memory::sample();
+        eval.workload = scenario.make(*eval.tl);
+        auto const after = Memory::sample();
+        eval.memory   = before.resident == Memory::invalid_size || after.resident == Memory::invalid_size ? Memory::invalid_size : after.resident - before.resident;
+        eval.memory_peak = eval.memory;
+        eval.workload->set_open_loop(nbworkers, rate);
+        eval.samples  = {counters, counters, counters};
+        eval.usages   = {true, true, true};
+        eval.transactions = TransactionCounters{0, 0, 0};
+        eval.error    = nullptr;
+    }
+    // Library evaluations
+    auto const pertxdiv = static_cast<double>(nbworkers) * static_cast<double>(nbtxperwrk);
+    auto maxtick_init = Chrono::invalid_tick;
+    auto maxtick_perf = Chrono::invalid_tick;
+    auto maxtick_chck = Chrono::invalid_tick;
+    /** Compute the timeout of a library for a phase, from the reference's duration.
+     * @param tick Reference duration
+     * @return Timeout
+    **/
+    auto const slowed = [&](Chrono::Tick tick) {
+        if (slow_factor == 0)
+            return Chrono::invalid_tick;
+        auto res = slow_factor * tick;
+        if (unlikely(res == Chrono::invalid_tick)) // Bad luck...
+            ++res;
+        return res;
+    };
     try {
-        char const* error = nullptr;
-        Chrono::Tick time_init = Chrono::invalid_tick;
-        Chrono::Tick times[nbrepeats];
-        Chrono::Tick time_chck = Chrono::invalid_tick;
-        auto const posmedian = nbrepeats / 2;
-        { // Initialization (with cheap correctness test)
-            sync.master_notify(); // We tell workers to start working.
-            auto res = sync.master_wait(maxtick_init); // If running the student's version, it will timeout if way slower than the reference.
-            if (unlikely(::std::holds_alternative<char const*>(res))) { // If an error happened (timeout or violation), we return early!
-                error = ::std::get<char const*>(res);
-                goto join;
+        Pool pool{static_cast<unsigned int>(nbworkers), placement, counters};
+        /** Run one phase of a library, recording its error if any.
+         * @param eval    Library evaluation
+         * @param phase   Phase to run
+         * @param seed    Seed of the phase
+         * @param maxtick Timeout ('Chrono::invalid_tick' for none)
+         * @return Phase result
+        **/
+        auto const run = [&](Evaluation& eval, Pool::Phase phase, Seed seed, Chrono::Tick maxtick) {
+            auto const peaked = Memory::reset_peak();
+            auto const before = Memory::sample();
+            auto res = pool.run(*eval.workload, phase, seed, maxtick);
+            if (eval.memory != Memory::invalid_size) { // Other libraries' memory cancels out in the differences
+                auto const after = Memory::sample();
+                auto const peak  = eval.memory + after.peak - before.resident;
+                eval.memory += after.resident - before.resident;
+                if (eval.memory_peak != Memory::invalid_size)
+                    eval.memory_peak = peaked && after.peak != Memory::invalid_size ? ::std::max(eval.memory_peak, peak) : Memory::invalid_size;
+            }
+            eval.samples[static_cast<size_t>(phase)] += res.counters;
+            eval.usages[static_cast<size_t>(phase)] += res.usage;
+            if (phase == Pool::Phase::perf)
+                eval.transactions += res.transactions;
+            eval.error = res.error;
+            return res;
+        };
+        /** Run the performance measurement of one repetition of a library.
+         * @param index Index of the library
+         * @param count Repetition index
+         * @return Whether the repetition succeeded
+        **/
+        auto const repeat = [&](size_t index, size_t count) {
+            auto&& eval = evals[index];
+            { // Untimed preparation, e.g. pre-generating the random decisions of the repetition
+                auto res = pool.run(*eval.workload, Pool::Phase::prepare, seed + nbworkers * count, Chrono::invalid_tick);
+                eval.error = res.error;
+                if (unlikely(res.error))
+                    return false;
+                eval.preps.push_back(static_cast<double>(res.time));
             }
-            time_init = ::std::get<Chrono>(res).get_tick();
+            auto res = run(eval, Pool::Phase::perf, seed + nbworkers * count, index == 0 ? Chrono::invalid_tick : maxtick_perf);
+            if (unlikely(res.error))
+                return false;
+            eval.times.push_back(static_cast<double>(res.time));
+            eval.fairness.push_back(Fairness::measure(res.commits, res.finishes));
+            if (index == 0) // Reference performance sets the timeout of the others, from the median so far
+                maxtick_perf = slowed(static_cast<Chrono::Tick>(Stats::median(eval.times)));
+            return true;
+        };
+        // 1. Initialization (with cheap correctness test), the reference first as it sets the timeout of the others
+        for (size_t i = 0; i < evals.size(); ++i) {
+            auto res = run(evals[i], Pool::Phase::init, seed, maxtick_init);
+            if (unlikely(res.error))
+                goto failed;
+            evals[i].time_init = res.time;
+            if (i == 0)
+                maxtick_init = slowed(res.time);
         }
-        { // Performance measurements (with cheap correctness tests)
-            for (unsigned int i = 0; i < nbrepeats; ++i) {
-                sync.master_notify();
-                auto res = sync.master_wait(maxtick_perf);
-                if (unlikely(::std::holds_alternative<char const*>(res))) {
-                    error = ::std::get<char const*>(res);
-                    goto join;
+        // 2. Performance measurements (with cheap correctness tests), alternating the libraries to cancel thermal and frequency drifts
+        if (interleaved) {
+            for (size_t count = 0; count < nbrepeats; ++count) {
+                for (size_t i = 0; i < evals.size(); ++i) {
+                    if (unlikely(!repeat(i, count)))
+                        goto failed;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < evals.size(); ++i) {
+                for (size_t count = 0; count < nbrepeats; ++count) {
+                    if (unlikely(!repeat(i, count)))
+                        goto failed;
                 }
-                times[i] = ::std::get<Chrono>(res).get_tick();
             }
-            ::std::nth_element(times, times + posmedian, times + nbrepeats); // Partition times around the median
         }
-        { // Correctness check
-            sync.master_notify();
-            auto res = sync.master_wait(maxtick_chck);
-            if (unlikely(::std::holds_alternative<char const*>(res))) {
-                error = ::std::get<char const*>(res);
-                goto join;
+        // 3. Correctness check
+        for (size_t i = 0; i < evals.size(); ++i) {
+            auto res = run(evals[i], Pool::Phase::check, seed, maxtick_chck);
+            if (unlikely(res.error))
+                goto failed;
+            evals[i].time_chck = res.time;
+            if (i == 0)
+                maxtick_chck = slowed(res.time);
+        }
+        failed: {}
+    } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit
+        ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl;
+        ::std::cerr << "⎩ " << err.what() << ::std::endl;
+#ifdef __APPLE__
+        ::std::exit(2);
+#else
+        ::std::quick_exit(2);
+#endif
+    }
+    // Print results
+    auto const& reference = evals[0].times;
+    for (size_t i = 0; i < evals.size(); ++i) {
+        auto&& eval = evals[i];
+        ::std::cout << "⎧ Evaluating '" << eval.path << "'" << (i == 0 ? " (reference)" : "") << "..." << ::std::endl;
+        // Check false negative-free correctness
+        if (unlikely(eval.error)) {
+            ::std::cout << "⎩ " << eval.error << ::std::endl;
+            return 1;
+        }
+        if (unlikely(eval.times.size() < nbrepeats)) { // Another library failed before this one was fully measured
+            ::std::cout << "⎩ <not measured>" << ::std::endl;
+            continue;
+        }
+        auto const perfdbl  = Stats::median(eval.times);
+        auto const interval = Stats::bootstrap_median(eval.times, confidence, nbresamples, seed);
+        ::std::cout << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
+        if (i > 0) // Compare with reference performance
+            ::std::cout << " -> " << (Stats::median(reference) / perfdbl) << " speedup";
+        ::std::cout << ::std::endl;
+        ::std::cout << "⎪ Execution time (ms):       mean " << (Stats::mean(eval.times) / 1000000.) << ", median " << (perfdbl / 1000000.) << ", stddev " << (Stats::stddev(eval.times) / 1000000.) << ", " << (confidence * 100.) << "% CI of median [" << (interval.low / 1000000.) << ", " << (interval.high / 1000000.) << "]" << ::std::endl;
+        if (i > 0) {
+            auto const speedup = Stats::bootstrap_ratio(reference, eval.times, interleaved, confidence, nbresamples, seed);
+            ::std::cout << "⎪ Speedup:                   " << (confidence * 100.) << "% CI [" << speedup.low << ", " << speedup.high << "] -> ";
+            if (speedup.contains(1.)) {
+                ::std::cout << "no significant difference" << ::std::endl;
+            } else {
+                ::std::cout << "significantly " << (speedup.low > 1. ? "faster" : "slower") << " than the reference" << ::std::endl;
+            }
+        }
+        if (counters) {
+            print_counters("Initialization counters: ", eval.samples[0], 1.);
+            print_counters("Counters per TX:         ", eval.samples[1], pertxdiv * nbrepeats);
+            print_counters("Correctness counters:    ", eval.samples[2], 1.);
+        }
+        { // Transaction outcomes, 'transactional' retrying aborted transactions
+            auto const begun   = static_cast<double>(eval.transactions.begun);
+            auto const aborted = static_cast<double>(eval.transactions.aborted);
+            auto const idle    = static_cast<double>(eval.transactions.idle);
+            throughputs[i] = (begun - aborted) / (Stats::mean(eval.times) * static_cast<double>(eval.times.size()) / 1000000000.);
+            ::std::cout << "⎪ Committed TX throughput:   " << throughputs[i] << " TX/s, abort rate " << (begun > 0. ? aborted / begun * 100. : 0.) << " %";
+            if (idle > 0.) // E.g. polls of a full or empty queue
+                ::std::cout << ", " << (idle / (begun - aborted) * 100.) << " % of the commits idle (left out of the fairness)";
+            ::std::cout << ::std::endl;
+        }
+        if (nbworkers > 1) { // Per-thread fairness, fixed-work workloads showing unfairness in the completion times rather than the commit counts
+            for (size_t count = 0; count < eval.fairness.size(); ++count) {
+                auto&& fair = eval.fairness[count];
+                ::std::ostringstream label;
+                label << "Fairness, repetition " << (count + 1) << ":";
+                ::std::cout << "⎪ " << label.str() << ::std::string(label.str().size() < 26 ? 26 - label.str().size() : 1, ' ')
+                    << "commits " << fair.min_commits << " to " << fair.max_commits << " per thread, finish " << (static_cast<double>(fair.min_finish) / 1000000.) << " to " << (static_cast<double>(fair.max_finish) / 1000000.) << " ms, "
+                    << "Jain index " << fair.jain_commits << " (commits), " << fair.jain_rates << " (commit rates)" << ::std::endl;
+            }
+        }
+        if (rate > 0.) { // Latency from the scheduled arrival, so including the queueing delay behind late transactions
+            auto const latencies = eval.workload->get_latencies();
+            if (latencies.get_count() > 0) {
+                ::std::cout << "⎪ Open-loop latency (µs):    p50 " << (latencies.quantile(0.5) / 1000.) << ", p90 " << (latencies.quantile(0.9) / 1000.) << ", p99 " << (latencies.quantile(0.99) / 1000.) << ", p99.9 " << (latencies.quantile(0.999) / 1000.) << ", max " << (static_cast<double>(latencies.get_max()) / 1000.) << ::std::endl;
+                ::std::cout << "⎪ Completed operation rate:  " << (static_cast<double>(latencies.get_count()) / (Stats::mean(eval.times) * static_cast<double>(eval.times.size()) / 1000000000.)) << " TX/s (offered " << (rate * static_cast<double>(nbworkers)) << " TX/s)" << ::std::endl;
             }
-            time_chck = ::std::get<Chrono>(res).get_tick();
         }
-        join: { // Joining
-            sync.master_join(); // Join with threads
-            for (unsigned int i = 0; i < nbthreads; ++i)
-                threads[i].join();
+        { // CPU time against wall time, spinning burning CPU time where blocking does not
+            Chrono::Tick const walls[] = {eval.time_init, static_cast<Chrono::Tick>(Stats::mean(eval.times) * static_cast<double>(eval.times.size())), eval.time_chck};
+            char const* const names[]  = {"init", "perf", "check"};
+            ::std::cout << "⎪ CPU time (ms):             ";
+            if (unlikely(!eval.usages[0].valid || !eval.usages[1].valid || !eval.usages[2].valid)) {
+                ::std::cout << "<unavailable>" << ::std::endl;
+            } else {
+                for (size_t phase = 0; phase < 3; ++phase) {
+                    auto&& usage = eval.usages[phase];
+                    auto const wall = static_cast<double>(walls[phase]) * static_cast<double>(nbworkers);
+                    ::std::cout << (phase > 0 ? "; " : "") << names[phase] << " " << (static_cast<double>(usage.user) / 1000000.) << " user + " << (static_cast<double>(usage.system) / 1000000.) << " sys ("
+                        << (wall > 0. ? static_cast<double>(usage.user + usage.system) / wall * 100. : 0.) << " % of wall x threads)";
+                }
+                ::std::cout << ::std::endl;
+                auto&& usage = eval.usages[1];
+                ::std::cout << "⎪ Context switches:          " << usage.voluntary << " voluntary, " << usage.involuntary << " involuntary (" << (static_cast<double>(usage.voluntary + usage.involuntary) / (pertxdiv * static_cast<double>(nbrepeats))) << " per TX)" << ::std::endl;
+            }
         }
-        return ::std::make_tuple(error, time_init, times[posmedian], time_chck);
-    } catch (...) {
-        for (unsigned int i = 0; i < nbthreads; ++i) // Detach threads to avoid termination due to attached thread going out of scope
-            threads[i].detach();
-        throw;
+        ::std::cout << "⎪ Memory footprint:          ";
+        if (unlikely(eval.memory == Memory::invalid_size)) {
+            ::std::cout << "<unavailable>" << ::std::endl;
+        } else {
+            auto const user = static_cast<double>(eval.workload->get_user_size());
+            ::std::cout << (static_cast<double>(eval.memory) / 1048576.) << " MiB resident, peak ";
+            if (eval.memory_peak == Memory::invalid_size) {
+                ::std::cout << "<unavailable>";
+            } else {
+                ::std::cout << (static_cast<double>(eval.memory_peak) / 1048576.) << " MiB";
+            }
+            ::std::cout << " -> " << ((static_cast<double>(eval.memory) - user) / user) << " B of overhead per B of user data (" << (user / 1024.) << " KiB)" << ::std::endl;
+        }
+        if (floor.time > 0.) { // Worker time not explained by the workload and harness alone, the CPU time of the workers if available (spinning included), else wall x threads
+            auto&& usage = eval.usages[1];
+            auto const worker = usage.valid ? static_cast<double>(usage.user + usage.system) / static_cast<double>(eval.times.size()) : perfdbl * static_cast<double>(nbworkers);
+            ::std::cout << "⎪ Time above the floor:      " << ((worker - floor.time) / 1000000.) << " ms of worker " << (usage.valid ? "CPU time" : "time (wall x threads)") << " per repetition, i.e. " << ((worker - floor.time) / worker * 100.) << " % of it spent in the library" << ::std::endl;
+        }
+        if (harness) { // Work of the workload moved out of the measured runs, e.g. pre-generated random decisions
+            auto const prep = Stats::mean(eval.preps);
+            ::std::cout << "⎪ Harness overhead:          " << (prep / 1000000.) << " ms of untimed preparation per repetition, i.e. " << (prep / Stats::mean(eval.times) * 100.) << " % of the measured time it is excluded from" << ::std::endl;
+        }
+        eval.workload->report(Stats::mean(eval.times) * static_cast<double>(eval.times.size()) / 1000000000.);
+        ::std::cout << "⎩ Average TX execution time: " << (perfdbl / pertxdiv) << " ns" << ::std::endl;
     }
+    return 0;
 }
 
 // -------------------------------------------------------------------------- //
@@ -257,96 +991,131 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
 int main(int argc, char** argv) {
     try {
         // Parse command line option(s)
-        if (argc < 3) {
-            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " <seed> <reference library path> <tested library path>..." << ::std::endl;
+        Arguments const args{argc, argv};
+        if (args.size() < 2) {
+            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " [--option=value]... <seed> <reference library path> <tested library path>..." << ::std::endl;
+            ::std::cout << "Options:" << ::std::endl;
+            ::std::cout << "  --threads=<n>      Number of worker threads (default: number of hardware threads)" << ::std::endl;
+            ::std::cout << "  --oversubscribe    Also evaluate at 2, 4 and 8 times the number of worker threads on the same data, and summarize the throughput collapse" << ::std::endl;
+            ::std::cout << "  --oversubscribe=<factors> Same, at the given comma-separated multiples (e.g. 2,4,8)" << ::std::endl;
+            ::std::cout << "  --pin=<policy>     Worker thread pinning, one of 'none' (default), 'compact', 'scatter' or 'core'" << ::std::endl;
+            ::std::cout << "  --counters         Sample hardware performance counters (cycles, cache, LLC and branch misses, context switches) per phase" << ::std::endl;
+            ::std::cout << "  --workload=<name>  Workload to run, one of 'bank' (default), 'hashmap', 'list', 'skiplist', 'rbtree', 'queue', 'vacation', 'labyrinth', 'blocks', 'churn' or 'replay'" << ::std::endl;
+            ::std::cout << "  --keys=<dist>      Key selection (bank transfers, maps and sets): 'uniform' (default), 'zipf:<θ>' or 'hotspot:<fraction of keys>:<probability of access>'" << ::std::endl;
+            ::std::cout << "  --range=<n>        Number of distinct keys (hash map, skip list, red-black tree, default: 1024 per worker; list, default: 512)" << ::std::endl;
+            ::std::cout << "  --updates=<p>      Probability of an update transaction (maps, sets and blocks, default: 0.1)" << ::std::endl;
+            ::std::cout << "  --levels=<n>       Number of skip list levels (default: log2 of the range)" << ::std::endl;
+            ::std::cout << "  --nodes=<mode>     List, tree and reservation node allocation: 'pool' (default, preallocated in the first segment) or 'segment' (one allocation per node)" << ::std::endl;
+            ::std::cout << "  --producers=<n>    Number of producer threads, the other ones consuming (queue, default: half of the threads)" << ::std::endl;
+            ::std::cout << "  --capacity=<n>     Number of slots in the ring (queue, default: 64)" << ::std::endl;
+            ::std::cout << "  --preset=<name>    Bank mix: 'default' (50% scans, other TX transfers), 'read-heavy' (95% read-only TX), 'balanced' (50%), 'write-heavy' (5%) or 'scan' (scans only)" << ::std::endl;
+            ::std::cout << "                     Vacation contention: 'low' (default, STAMP's -n2 -q90 -u98) or 'high' (-n4 -q60 -u90)" << ::std::endl;
+            ::std::cout << "  --relations=<n>    Number of cars, flights, rooms and customers (vacation, default: 4096)" << ::std::endl;
+            ::std::cout << "  --queries=<n>      Maximum number of queries per transaction (vacation, default: from the preset)" << ::std::endl;
+            ::std::cout << "  --query-range=<%>  Percentage of the relations queried (vacation, default: from the preset)" << ::std::endl;
+            ::std::cout << "  --user=<%>         Percentage of reservation transactions (vacation, default: from the preset)" << ::std::endl;
+            ::std::cout << "  --grid=<n>         Side of the grid, in cells (labyrinth, default: 128)" << ::std::endl;
+            ::std::cout << "  --region=<n>       Side of the region each transaction reads and routes in (labyrinth, default: 16)" << ::std::endl;
+            ::std::cout << "  --paths=<n>        Number of paths each worker keeps laid (labyrinth, default: 8)" << ::std::endl;
+            ::std::cout << "  --records=<n>      Number of records (blocks, default: 64)" << ::std::endl;
+            ::std::cout << "  --record-size=<n>  Size of a record, in bytes (blocks, default: 4096)" << ::std::endl;
+            ::std::cout << "  --chunk-size=<n>   Size of each read/write access to a record, in bytes (blocks, default: the record size)" << ::std::endl;
+            ::std::cout << "  --live=<n>         Maximum number of live allocated segments (churn, default: 32)" << ::std::endl;
+            ::std::cout << "  --min-size=<n>     Minimum size of an allocated segment, in bytes (churn, default: 24)" << ::std::endl;
+            ::std::cout << "  --max-size=<n>     Maximum size of an allocated segment, in bytes (churn, default: 4096)" << ::std::endl;
+            ::std::cout << "  --trace=<path>     Trace file to replay, as written by the recorder library (replay, default: tm.trace)" << ::std::endl;
+            ::std::cout << "  --trace-pace       Start each replayed transaction at its recorded time, instead of as soon as possible (replay)" << ::std::endl;
+            ::std::cout << "  --rate=<n>         Open-loop runs: per-thread arrival rate of the transactions, on a Poisson process, in TX/s (default: 0 for closed-loop runs)" << ::std::endl;
+            ::std::cout << "  --slow-factor=<n>  Timeout of a tested library, in multiples of the reference's duration of the same phase (default: 16, 0 for none)" << ::std::endl;
+            ::std::cout << "  --repeats=<n>      Number of repetitions per library (default: 7)" << ::std::endl;
+            ::std::cout << "  --floor=<path>     Null library (e.g. ../null.so) running the same worker runs in turn on one thread (pinned if possible), to report each library's time above the workload and harness cost" << ::std::endl;
+            ::std::cout << "  --harness-overhead Report the untimed preparation of each repetition (e.g. the bank's pre-generated random decisions), relative to the measured time" << ::std::endl;
+            ::std::cout << "  --sequential       Run all the repetitions of a library before the next one, instead of interleaving the libraries" << ::std::endl;
+            ::std::cout << "  --confidence=<p>   Confidence level of the bootstrap intervals (default: 0.95)" << ::std::endl;
+            ::std::cout << "  --resamples=<n>    Number of bootstrap resamples (default: 10000)" << ::std::endl;
             return 1;
         }
         // Get/set/compute run parameters
-        auto const nbworkers = []() {
+        Topology const topology;
+        auto const nbworkers = args.get<size_t>("threads", []() {
             auto res = ::std::thread::hardware_concurrency();
             if (unlikely(res == 0))
                 res = 16;
             return static_cast<size_t>(res);
-        }();
-        auto const nbtxperwrk    = 200000ul / nbworkers;
-        auto const nbaccounts    = 32 * nbworkers;
-        auto const expnbaccounts = 256 * nbworkers;
-        auto const init_balance  = 100ul;
-        auto const prob_long     = 0.5f;
-        auto const prob_alloc    = 0.01f;
-        auto const nbrepeats     = 7;
-        auto const seed          = static_cast<Seed>(::std::stoul(argv[1]));
-        auto const clk_res       = Chrono::get_resolution();
-        auto const slow_factor   = 16ul;
-        // Print run parameters
-        ::std::cout << "⎧ #worker threads:     " << nbworkers << ::std::endl;
-        ::std::cout << "⎪ #TX per worker:      " << nbtxperwrk << ::std::endl;
-        ::std::cout << "⎪ #repetitions:        " << nbrepeats << ::std::endl;
-        ::std::cout << "⎪ Initial #accounts:   " << nbaccounts << ::std::endl;
-        ::std::cout << "⎪ Expected #accounts:  " << expnbaccounts << ::std::endl;
-        ::std::cout << "⎪ Initial balance:     " << init_balance << ::std::endl;
-        ::std::cout << "⎪ Long TX probability: " << prob_long << ::std::endl;
-        ::std::cout << "⎪ Allocation TX prob.: " << prob_alloc << ::std::endl;
-        ::std::cout << "⎪ Slow trigger factor: " << slow_factor << ::std::endl;
-        ::std::cout << "⎪ Clock resolution:    ";
-        if (unlikely(clk_res == Chrono::invalid_tick)) {
-            ::std::cout << "<unknown>" << ::std::endl;
-        } else {
-            ::std::cout << clk_res << " ns" << ::std::endl;
+        }());
+        auto const pinning       = Topology::parse(args.get<::std::string>("pin", "none"));
+        auto const counters      = args.get<bool>("counters", false);
+        auto const nbrepeats     = args.get<size_t>("repeats", 7);
+        auto const interleaved   = !args.get<bool>("sequential", false);
+        auto const confidence    = args.get<double>("confidence", 0.95);
+        auto const nbresamples   = args.get<size_t>("resamples", 10000);
+        auto const seed          = static_cast<Seed>(::std::stoul(args[0]));
+        auto const slow_factor   = args.get<Chrono::Tick>("slow-factor", 16);
+        auto const rate          = args.get<double>("rate", 0.);
+        auto const oversubscribe = args.get<::std::string>("oversubscribe", "off");
+        auto const harness       = args.get<bool>("harness-overhead", false);
+        auto const floor_path    = args.get<::std::string>("floor", "");
+        if (unlikely(nbworkers == 0))
+            throw Exception::ArgumentValue{"at least one worker thread is required"};
+        select_workload(args, nbworkers, nbworkers, 200000ul / nbworkers); // Parse the workload options before checking for unknown ones
+        args.check();
+        if (unlikely(nbrepeats == 0))
+            throw Exception::ArgumentValue{"at least one repetition is required"};
+        if (unlikely(!(confidence > 0. && confidence < 1.)))
+            throw Exception::ArgumentValue{"the confidence level must be in ]0, 1["};
+        if (unlikely(nbresamples == 0))
+            throw Exception::ArgumentValue{"at least one bootstrap resample is required"};
+        if (unlikely(!(rate >= 0.)))
+            throw Exception::ArgumentValue{"the arrival rate must be non-negative"};
+        ::std::vector<size_t> factors; // Multiples of the number of worker threads to evaluate at, the first one being 1 (none for a single evaluation)
+        if (oversubscribe != "off") {
+            factors.push_back(1);
+            ::std::istringstream stream{oversubscribe.empty() ? "2,4,8" : oversubscribe};
+            ::std::string item;
+            while (::std::getline(stream, item, ',')) {
+                size_t factor;
+                ::std::istringstream item_stream{item};
+                if (unlikely(!(item_stream >> factor) || !item_stream.eof() || factor < 2))
+                    throw Exception::ArgumentValue{"the oversubscription factors must be integers of at least 2"};
+                factors.push_back(factor);
+            }
         }
-        ::std::cout << "⎩ Seed value:          " << seed << ::std::endl;
-        // Library evaluations
-        double reference = 0.; // Set to avoid irrelevant '-Wmaybe-uninitialized'
-        auto const pertxdiv = static_cast<double>(nbworkers) * static_cast<double>(nbtxperwrk);
-        auto maxtick_init = Chrono::invalid_tick;
-        auto maxtick_perf = Chrono::invalid_tick;
-        auto maxtick_chck = Chrono::invalid_tick;
-        for (auto i = 2; i < argc; ++i) {
-            ::std::cout << "⎧ Evaluating '" << argv[i] << "'" << (maxtick_init == Chrono::invalid_tick ? " (reference)" : "") << "..." << ::std::endl;
-            // Load TM library
-            TransactionalLibrary tl{argv[i]};
-            // Initialize workload (shared memory lifetime bound to workload: created and destroyed at the same time)
-            WorkloadBank bank{tl, nbworkers, nbtxperwrk, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc};
-            try {
-                // Actual performance measurements and correctness check
-                auto res = measure(bank, nbworkers, nbrepeats, seed, maxtick_init, maxtick_perf, maxtick_chck);
-                // Check false negative-free correctness
-                auto error = ::std::get<0>(res);
-                if (unlikely(error)) {
-                    ::std::cout << "⎩ " << error << ::std::endl;
-                    return 1;
+        Settings const settings{args, topology, pinning, counters, nbrepeats, interleaved, confidence, nbresamples, seed, slow_factor, rate, harness, floor_path};
+        ::std::vector<double> throughputs;
+        if (factors.empty())
+            return evaluate(settings, nbworkers, nbworkers, throughputs);
+        // Oversubscription sweep, each library's throughput compared with the reference's and with its own at the base number of threads,
+        // the shared data and total transaction count staying those of the base number of threads so that only the thread count varies
+        ::std::vector<::std::vector<double>> sweep;
+        for (auto factor: factors) {
+            auto const res = evaluate(settings, factor * nbworkers, nbworkers, throughputs);
+            if (unlikely(res != 0))
+                return res;
+            sweep.push_back(throughputs);
+        }
+        ::std::cout << "⎧ Oversubscription summary, committed TX/s (vs. the reference, vs. " << nbworkers << " thread(s))..." << ::std::endl;
+        for (size_t i = 0; i < factors.size(); ++i) {
+            ::std::cout << (i + 1 < factors.size() ? "⎪ " : "⎩ ") << factors[i] << "x (" << (factors[i] * nbworkers) << " threads):";
+            for (size_t j = 0; j < sweep[i].size(); ++j) {
+                auto const tput = sweep[i][j];
+                ::std::cout << (j > 0 ? ";" : "") << " '" << args[j + 1] << "' ";
+                if (unlikely(tput <= 0.)) {
+                    ::std::cout << "<not measured>";
+                    continue;
                 }
-                // Print results
-                auto tick_init = ::std::get<1>(res);
-                auto tick_perf = ::std::get<2>(res);
-                auto tick_chck = ::std::get<3>(res);
-                auto perfdbl = static_cast<double>(tick_perf);
-                ::std::cout << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
-                if (maxtick_init == Chrono::invalid_tick) { // Set reference performance
-                    maxtick_init = slow_factor * tick_init;
-                    if (unlikely(maxtick_init == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_init;
-                    maxtick_perf = slow_factor * tick_perf;
-                    if (unlikely(maxtick_perf == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_perf;
-                    maxtick_chck = slow_factor * tick_chck;
-                    if (unlikely(maxtick_chck == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_chck;
-                    reference = perfdbl;
-                } else { // Compare with reference performance
-                    ::std::cout << " -> " << (reference / perfdbl) << " speedup";
+                ::std::cout << tput << " (";
+                if (j > 0 && sweep[i][0] > 0.) {
+                    ::std::cout << (tput / sweep[i][0]) << "x, ";
+                } else {
+                    ::std::cout << "-, ";
+                }
+                if (sweep[0][j] > 0.) {
+                    ::std::cout << (tput / sweep[0][j] * 100.) << " %)";
+                } else {
+                    ::std::cout << "-)";
                 }
-                ::std::cout << ::std::endl;
-                ::std::cout << "⎩ Average TX execution time: " << (perfdbl / pertxdiv) << " ns" << ::std::endl;
-            } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit
-                ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl;
-                ::std::cerr << "⎩ " << err.what() << ::std::endl;
-#ifdef __APPLE__
-                ::std::exit(2);
-#else
-                ::std::quick_exit(2);
-#endif
             }
+            ::std::cout << ::std::endl;
         }
         return 0;
     } catch (::std::exception const& err) {
@@ -0,0 +1,101 @@
+/**
+ * @file   memory.hpp
+ * @author Will Yu (?@epfl.ch)
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Process memory footprint sampling.
+**/
+
+#pragma once
+
+// External headers
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+extern "C" {
+#include <sys/resource.h>
+}
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Process memory footprint class.
+**/
+class Memory final {
+public:
+    /** Size class (in bytes), signed as differences of samples can be negative.
+    **/
+    using Size = int64_t;
+    constexpr static auto invalid_size = Size{-1}; // Unavailable size value
+    /** Footprint sample class.
+    **/
+    struct Sample {
+        Size resident; // Resident set size ('invalid_size' if unavailable)
+        Size peak;     // Peak resident set size since the process start or the last 'reset_peak' ('invalid_size' if unavailable)
+    };
+public:
+    /** Sample the current footprint of the process.
+     * @return Sampled footprint
+    **/
+    static Sample sample() noexcept {
+        Sample res{invalid_size, invalid_size};
+#ifdef __linux__
+        auto file = ::std::fopen("/proc/self/status", "r");
+        if (likely(file)) {
+            char line[256];
+            while (::std::fgets(line, sizeof(line), file)) {
+                long long kib;
+                if (::std::sscanf(line, "VmRSS: %lld kB", &kib) == 1) {
+                    res.resident = static_cast<Size>(kib) * 1024;
+                } else if (::std::sscanf(line, "VmHWM: %lld kB", &kib) == 1) {
+                    res.peak = static_cast<Size>(kib) * 1024;
+                }
+            }
+            ::std::fclose(file);
+        }
+#endif
+        if (unlikely(res.peak == invalid_size)) { // Fall back on the process' maximum, in KiB on Linux and in bytes on macOS
+            struct ::rusage usage;
+            if (likely(::getrusage(RUSAGE_SELF, &usage) == 0)) {
+#ifdef __APPLE__
+                res.peak = static_cast<Size>(usage.ru_maxrss);
+#else
+                res.peak = static_cast<Size>(usage.ru_maxrss) * 1024;
+#endif
+            }
+        }
+        return res;
+    }
+    /** Reset the peak resident set size to the current one.
+     * @return Whether the peak could be reset, otherwise it is the maximum since the process start
+    **/
+    static bool reset_peak() noexcept {
+#ifdef __linux__
+        auto file = ::std::fopen("/proc/self/clear_refs", "w");
+        if (unlikely(!file))
+            return false;
+        auto res = ::std::fputs("5", file) >= 0;
+        res = ::std::fclose(file) == 0 && res;
+        return res;
+#else
+        return false;
+#endif
+    }
+};
@@ -0,0 +1,175 @@
+/**
+ * @file   stats.hpp
+ * @author Will Yu (?@epfl.ch)
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Descriptive statistics and bootstrap confidence intervals over repeated measurements.
+**/
+
+#pragma once
+
+// External headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Stats {
+
+/** Compute the arithmetic mean of a non-empty sample.
+ * @param sample Sample
+ * @return Mean
+**/
+static inline double mean(::std::vector<double> const& sample) noexcept {
+    auto sum = 0.;
+    for (auto value: sample)
+        sum += value;
+    return sum / static_cast<double>(sample.size());
+}
+
+/** Compute the median of a non-empty sample (average of the two middle values for even sizes).
+ * @param sample Sample (copied, as partially sorted)
+ * @return Median
+**/
+static inline double median(::std::vector<double> sample) noexcept {
+    auto const mid = sample.size() / 2;
+    ::std::nth_element(sample.begin(), sample.begin() + mid, sample.end());
+    auto res = sample[mid];
+    if (sample.size() % 2 == 0)
+        res = (res + *::std::max_element(sample.begin(), sample.begin() + mid)) / 2.;
+    return res;
+}
+
+/** Compute the (Bessel-corrected) standard deviation of a non-empty sample.
+ * @param sample Sample
+ * @return Standard deviation, 0 for a single value
+**/
+static inline double stddev(::std::vector<double> const& sample) noexcept {
+    if (sample.size() < 2)
+        return 0.;
+    auto const avg = mean(sample);
+    auto sum = 0.;
+    for (auto value: sample)
+        sum += (value - avg) * (value - avg);
+    return ::std::sqrt(sum / static_cast<double>(sample.size() - 1));
+}
+
+/** Get the given quantile of a sample, by linear interpolation.
+ * @param sorted Non-empty sample, sorted
+ * @param level  Quantile level in [0, 1]
+ * @return Quantile
+**/
+static inline double quantile(::std::vector<double> const& sorted, double level) noexcept {
+    auto const pos = level * static_cast<double>(sorted.size() - 1);
+    auto const low = static_cast<size_t>(pos);
+    if (low + 1 >= sorted.size())
+        return sorted.back();
+    return sorted[low] + (pos - static_cast<double>(low)) * (sorted[low + 1] - sorted[low]);
+}
+
+/** Compute Jain's fairness index of a non-empty sample of non-negative allocations.
+ * @param sample Sample
+ * @return Index in [1/n, 1], 1 when all the allocations are equal, 0 if they are all 0
+**/
+static inline double jain(::std::vector<double> const& sample) noexcept {
+    auto sum = 0.;
+    auto sqr = 0.;
+    for (auto value: sample) {
+        sum += value;
+        sqr += value * value;
+    }
+    return sqr > 0. ? sum * sum / (static_cast<double>(sample.size()) * sqr) : 0.;
+}
+
+/** Confidence interval class.
+**/
+struct Interval {
+    double low;  // Lower bound
+    double high; // Upper bound
+    /** Check whether the interval contains a value.
+     * @param value Value to check
+     * @return Whether the value is in the interval
+    **/
+    bool contains(double value) const noexcept {
+        return low <= value && value <= high;
+    }
+};
+
+/** Percentile bootstrap confidence interval of the median of a sample.
+ * @param sample      Non-empty sample
+ * @param confidence  Confidence level in ]0, 1[
+ * @param nbresamples Number of bootstrap resamples
+ * @param seed        Seed of the resampling
+ * @return Confidence interval
+**/
+static inline Interval bootstrap_median(::std::vector<double> const& sample, double confidence, size_t nbresamples, uint_fast32_t seed) {
+    ::std::minstd_rand engine{seed};
+    ::std::uniform_int_distribution<size_t> pick{0, sample.size() - 1};
+    ::std::vector<double> resample(sample.size());
+    ::std::vector<double> medians(nbresamples);
+    for (auto&& res: medians) {
+        for (auto&& value: resample)
+            value = sample[pick(engine)];
+        res = median(resample);
+    }
+    ::std::sort(medians.begin(), medians.end());
+    return Interval{quantile(medians, (1. - confidence) / 2.), quantile(medians, (1. + confidence) / 2.)};
+}
+
+/** Percentile bootstrap confidence interval of the ratio of the medians of two samples.
+ * @param num         Non-empty numerator sample
+ * @param den         Non-empty denominator sample
+ * @param paired      Whether the samples are paired (same size, i-th values measured together), so they are resampled jointly
+ * @param confidence  Confidence level in ]0, 1[
+ * @param nbresamples Number of bootstrap resamples
+ * @param seed        Seed of the resampling
+ * @return Confidence interval
+**/
+static inline Interval bootstrap_ratio(::std::vector<double> const& num, ::std::vector<double> const& den, bool paired, double confidence, size_t nbresamples, uint_fast32_t seed) {
+    ::std::minstd_rand engine{seed};
+    ::std::uniform_int_distribution<size_t> pick_num{0, num.size() - 1};
+    ::std::uniform_int_distribution<size_t> pick_den{0, den.size() - 1};
+    ::std::vector<double> resample_num(num.size());
+    ::std::vector<double> resample_den(den.size());
+    ::std::vector<double> ratios(nbresamples);
+    for (auto&& res: ratios) {
+        if (paired) {
+            for (size_t i = 0; i < resample_num.size(); ++i) {
+                auto pick = pick_num(engine);
+                resample_num[i] = num[pick];
+                resample_den[i] = den[pick];
+            }
+        } else {
+            for (auto&& value: resample_num)
+                value = num[pick_num(engine)];
+            for (auto&& value: resample_den)
+                value = den[pick_den(engine)];
+        }
+        res = median(resample_num) / median(resample_den);
+    }
+    ::std::sort(ratios.begin(), ratios.end());
+    return Interval{quantile(ratios, (1. - confidence) / 2.), quantile(ratios, (1. + confidence) / 2.)};
+}
+
+}
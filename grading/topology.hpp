@@ -0,0 +1,242 @@
+/**
+ * @file   topology.hpp
+ * @author Will Yu (?@epfl.ch)
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * CPU topology discovery and worker thread pinning.
+**/
+
+#pragma once
+
+// External headers
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+extern "C" {
+#include <pthread.h>
+#include <sched.h>
+}
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Topology, Any, "CPU topology exception");
+    EXCEPTION(TopologyPolicy, Topology, "unknown thread pinning policy (expected 'none', 'compact', 'scatter' or 'core')");
+    EXCEPTION(TopologyPin, Topology, "unable to set the CPU affinity of a worker thread");
+
+}
+// -------------------------------------------------------------------------- //
+
+/** CPU topology class, restricted to the logical CPUs the process may run on.
+**/
+class Topology final {
+public:
+    /** Thread pinning policy class.
+    **/
+    enum class Policy {
+        none,    // No affinity, placement left to the scheduler
+        compact, // Fill each physical core (SMT siblings included), then each package
+        scatter, // Round-robin across packages, distinct physical cores first
+        core     // One worker per physical core, SMT siblings used only once all cores are taken
+    };
+    /** Logical CPU class.
+    **/
+    struct Cpu {
+        int id;      // Logical CPU ID
+        int package; // Physical package (socket) ID
+        int core;    // Physical core ID (unique within its package)
+        int smt;     // Rank among the SMT siblings of its physical core
+    };
+private:
+    ::std::vector<Cpu> cpus; // Usable logical CPUs, ordered by ID
+    size_t nbcores;          // Number of distinct physical cores
+    size_t nbpackages;       // Number of distinct packages
+private:
+    /** Read a non-negative integer from a sysfs file.
+     * @param cpu  Logical CPU ID
+     * @param name Name of the topology attribute
+     * @param def  Default value, if the attribute cannot be read
+     * @return Read value, or the default one
+    **/
+    static int read_attribute(int cpu, char const* name, int def) noexcept {
+        char path[128];
+        ::std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+        auto file = ::std::fopen(path, "r");
+        if (unlikely(!file))
+            return def;
+        int res;
+        if (unlikely(::std::fscanf(file, "%d", &res) != 1 || res < 0))
+            res = def;
+        ::std::fclose(file);
+        return res;
+    }
+public:
+    /** Discovery constructor.
+    **/
+    Topology(): nbcores{0}, nbpackages{0} {
+#ifdef __linux__
+        ::cpu_set_t set;
+        if (likely(::sched_getaffinity(0, sizeof(set), &set) == 0)) {
+            for (int id = 0; id < CPU_SETSIZE; ++id) {
+                if (CPU_ISSET(id, &set))
+                    cpus.push_back(Cpu{id, read_attribute(id, "physical_package_id", 0), read_attribute(id, "core_id", id), 0});
+            }
+        }
+#endif
+        if (cpus.empty()) { // Unknown topology, assume one package of single-threaded cores
+            auto count = static_cast<int>(::std::thread::hardware_concurrency());
+            for (int id = 0; id < ::std::max(count, 1); ++id)
+                cpus.push_back(Cpu{id, 0, id, 0});
+        }
+        ::std::vector<::std::pair<int, int>> cores;
+        ::std::vector<int> packages;
+        for (auto&& cpu: cpus) { // Rank SMT siblings, in ID order
+            ::std::pair<int, int> key{cpu.package, cpu.core};
+            cpu.smt = static_cast<int>(::std::count(cores.begin(), cores.end(), key));
+            cores.push_back(key);
+            if (::std::find(packages.begin(), packages.end(), cpu.package) == packages.end())
+                packages.push_back(cpu.package);
+        }
+        ::std::sort(cores.begin(), cores.end());
+        nbcores    = ::std::unique(cores.begin(), cores.end()) - cores.begin();
+        nbpackages = packages.size();
+    }
+public:
+    /** Get the number of usable logical CPUs.
+     * @return Number of logical CPUs
+    **/
+    auto get_nbcpus() const noexcept {
+        return cpus.size();
+    }
+    /** Get the number of physical cores hosting the usable logical CPUs.
+     * @return Number of physical cores
+    **/
+    auto get_nbcores() const noexcept {
+        return nbcores;
+    }
+    /** Get the number of packages hosting the usable logical CPUs.
+     * @return Number of packages
+    **/
+    auto get_nbpackages() const noexcept {
+        return nbpackages;
+    }
+    /** Compute the logical CPU each worker is pinned to.
+     * @param policy    Pinning policy
+     * @param nbworkers Number of workers
+     * @return Logical CPU ID for each worker (workers beyond the number of CPUs wrap around), empty for 'Policy::none'
+    **/
+    ::std::vector<int> placement(Policy policy, size_t nbworkers) const {
+        if (policy == Policy::none)
+            return {};
+        auto order = cpus;
+        switch (policy) {
+        case Policy::compact:
+            ::std::stable_sort(order.begin(), order.end(), [](Cpu const& a, Cpu const& b) {
+                return ::std::tie(a.package, a.core, a.smt) < ::std::tie(b.package, b.core, b.smt);
+            });
+            break;
+        case Policy::scatter: { // Rank CPUs within their package, then interleave packages
+            ::std::stable_sort(order.begin(), order.end(), [](Cpu const& a, Cpu const& b) {
+                return ::std::tie(a.package, a.smt, a.core) < ::std::tie(b.package, b.smt, b.core);
+            });
+            ::std::vector<int> rank(order.size());
+            for (size_t i = 1; i < order.size(); ++i)
+                rank[i] = order[i].package == order[i - 1].package ? rank[i - 1] + 1 : 0;
+            ::std::vector<size_t> index(order.size());
+            for (size_t i = 0; i < index.size(); ++i)
+                index[i] = i;
+            ::std::stable_sort(index.begin(), index.end(), [&](size_t a, size_t b) {
+                return ::std::tie(rank[a], order[a].package) < ::std::tie(rank[b], order[b].package);
+            });
+            decltype(order) interleaved;
+            for (auto i: index)
+                interleaved.push_back(order[i]);
+            order.swap(interleaved);
+        } break;
+        case Policy::core:
+            ::std::stable_sort(order.begin(), order.end(), [](Cpu const& a, Cpu const& b) {
+                return ::std::tie(a.smt, a.package, a.core) < ::std::tie(b.smt, b.package, b.core);
+            });
+            break;
+        default:
+            throw Exception::Unreachable{"unexpected thread pinning policy"};
+        }
+        ::std::vector<int> res(nbworkers);
+        for (size_t i = 0; i < nbworkers; ++i)
+            res[i] = order[i % order.size()].id;
+        return res;
+    }
+public:
+    /** Parse a pinning policy name, throw 'Exception::TopologyPolicy' if unknown.
+     * @param name Policy name
+     * @return Pinning policy
+    **/
+    static Policy parse(::std::string const& name) {
+        if (name == "none")
+            return Policy::none;
+        if (name == "compact")
+            return Policy::compact;
+        if (name == "scatter")
+            return Policy::scatter;
+        if (name == "core")
+            return Policy::core;
+        throw Exception::TopologyPolicy{};
+    }
+    /** Get the name of a pinning policy.
+     * @param policy Pinning policy
+     * @return Null-terminated policy name
+    **/
+    static char const* name(Policy policy) noexcept {
+        switch (policy) {
+        case Policy::compact:
+            return "compact";
+        case Policy::scatter:
+            return "scatter";
+        case Policy::core:
+            return "core";
+        default:
+            return "none";
+        }
+    }
+    /** Pin a thread on a logical CPU, throw 'Exception::TopologyPin' on failure.
+     * @param thread Thread to pin
+     * @param cpu    Logical CPU ID
+    **/
+    static void pin(::std::thread& thread, int cpu) {
+#ifdef __linux__
+        ::cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (unlikely(::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0))
+            throw Exception::TopologyPin{};
+#else
+        (void) thread;
+        (void) cpu;
+        throw Exception::TopologyPin{};
+#endif
+    }
+};
@@ -521,7 +521,7 @@ public:
      * @param source Private content to write at the shared address
     **/
     void write(size_t index, Type const& source) const {
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(&source, sizeof(Type), address + index);
     }
 public:
     /** Reference a cell.
@@ -580,7 +580,7 @@ public:
     void write(size_t index, Type const& source) const {
         if (unlikely(assert_mode && index >= n))
             throw Exception::SharedOverflow{};
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(&source, sizeof(Type), address + index);
     }
 public:
     /** Reference a cell.
@@ -602,6 +602,28 @@ public:
 
 // -------------------------------------------------------------------------- //
 
+/** Transaction outcome counters class, accumulable across threads and phases.
+**/
+struct TransactionCounters {
+    uint64_t begun;   // Number of started transactions (committed ones are the non-aborted ones)
+    uint64_t aborted; // Number of aborted transactions (retried by 'transactional')
+    uint64_t idle;    // Number of committed transactions that did no work, e.g. polls of a full or empty queue (counted by the workload)
+    /** Accumulate other counters.
+     * @param other Counters to accumulate
+     * @return Current counters
+    **/
+    TransactionCounters& operator+=(TransactionCounters const& other) noexcept {
+        begun   += other.begun;
+        aborted += other.aborted;
+        idle    += other.idle;
+        return *this;
+    }
+};
+
+/** Outcome counters of the transactions run by the calling thread through 'transactional'.
+**/
+static thread_local TransactionCounters transaction_counters{0, 0, 0};
+
 /** Repeat a given transaction until it commits.
  * @param tm   Transactional memory
  * @param mode Transactional mode
@@ -611,9 +633,11 @@ public:
 template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, Func&& func) {
     do {
         try {
+            ++transaction_counters.begun;
             Transaction tx{tm, mode};
             return func(tx);
         } catch (Exception::TransactionRetry const&) {
+            ++transaction_counters.aborted;
             continue;
         }
     } while (true);
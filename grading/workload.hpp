@@ -24,12 +24,36 @@
 #pragma once
 
 // External headers
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
 #include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 // Internal headers
+#include <trace.h>
 #include "common.hpp"
 
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Trace, Any, "trace file exception");
+    EXCEPTION(TraceOpen, Trace, "unable to open the trace file");
+    EXCEPTION(TraceFormat, Trace, "invalid or truncated trace file");
+
+}
 // -------------------------------------------------------------------------- //
 
 /** Worker unique ID type.
@@ -40,12 +64,336 @@ using Uid = uint_fast32_t;
 **/
 using Seed = uint_fast32_t;
 
+/** Key distribution class, drawing indexes in [0, n[ where index 0 is the most popular one.
+**/
+class KeyDistribution final {
+public:
+    /** Distribution kind enum.
+    **/
+    enum class Kind {
+        uniform, // Every key equally likely
+        zipf,    // Probability of the k-th key proportional to 1 / k^θ
+        hotspot  // A fraction of the keys (the "hot set") receives a fraction of the accesses, uniformly within each set
+    };
+private:
+    Kind   kind;     // Distribution kind
+    double theta;    // Zipf exponent
+    double hot_keys; // Fraction of the keys in the hot set
+    double hot_prob; // Probability of accessing the hot set
+    size_t cache_n;  // Number of keys the Zipf constants below were computed for (0 for none)
+    double cache_x1; // Zipf constant: integral of the hat function up to 1.5, minus 1
+    double cache_xn; // Zipf constant: integral of the hat function up to n + 0.5
+    double cache_s;  // Zipf constant: rejection-free width
+private:
+    /** Compute log(1 + x) / x, continuous at 0.
+    **/
+    static double helper1(double x) noexcept {
+        return ::std::abs(x) > 1e-8 ? ::std::log1p(x) / x : 1. - x / 2.;
+    }
+    /** Compute (exp(x) - 1) / x, continuous at 0.
+    **/
+    static double helper2(double x) noexcept {
+        return ::std::abs(x) > 1e-8 ? ::std::expm1(x) / x : 1. + x / 2.;
+    }
+    /** Zipf hat function, its integral and the inverse of its integral.
+    **/
+    double h(double x) const noexcept {
+        return ::std::exp(-theta * ::std::log(x));
+    }
+    double h_integral(double x) const noexcept {
+        auto log_x = ::std::log(x);
+        return helper2((1. - theta) * log_x) * log_x;
+    }
+    double h_integral_inverse(double x) const noexcept {
+        auto t = x * (1. - theta);
+        if (t < -1.) // Limit value to the range [-1, +inf[, preventing a NaN from rounding errors
+            t = -1.;
+        return ::std::exp(helper1(t) * x);
+    }
+    /** Draw from the Zipf distribution by rejection-inversion (Hörmann and Derflinger, 1996).
+     * @param engine Randomness source
+     * @param n      Number of keys
+     * @return Drawn index
+    **/
+    template<class Engine> size_t zipf(Engine& engine, size_t n) {
+        if (n != cache_n) { // Constants only depend on the number of keys
+            cache_n  = n;
+            cache_x1 = h_integral(1.5) - 1.;
+            cache_xn = h_integral(static_cast<double>(n) + 0.5);
+            cache_s  = 2. - h_integral_inverse(h_integral(2.5) - h(2.));
+        }
+        ::std::uniform_real_distribution<double> unit{0., 1.};
+        while (true) {
+            auto u = cache_xn + unit(engine) * (cache_x1 - cache_xn);
+            auto x = h_integral_inverse(u);
+            auto k = static_cast<size_t>(x + 0.5);
+            if (k < 1) {
+                k = 1;
+            } else if (k > n) {
+                k = n;
+            }
+            auto kdbl = static_cast<double>(k);
+            if (kdbl - x <= cache_s || u >= h_integral(kdbl + 0.5) - h(kdbl))
+                return k - 1;
+        }
+    }
+public:
+    /** Parameters constructor.
+     * @param kind     Distribution kind
+     * @param theta    Zipf exponent (for 'Kind::zipf')
+     * @param hot_keys Fraction of the keys in the hot set (for 'Kind::hotspot')
+     * @param hot_prob Probability of accessing the hot set (for 'Kind::hotspot')
+    **/
+    KeyDistribution(Kind kind = Kind::uniform, double theta = 0., double hot_keys = 0., double hot_prob = 0.) noexcept: kind{kind}, theta{theta}, hot_keys{hot_keys}, hot_prob{hot_prob}, cache_n{0} {}
+    /** Parse a distribution, throw 'Exception::ArgumentValue' if invalid.
+     * @param spec 'uniform', 'zipf:<θ>' or 'hotspot:<fraction of keys>:<probability of access>'
+     * @return Parsed distribution
+    **/
+    static KeyDistribution parse(::std::string const& spec) {
+        ::std::istringstream stream{spec};
+        ::std::string name;
+        ::std::getline(stream, name, ':');
+        if (name == "uniform" && stream.eof())
+            return KeyDistribution{};
+        char sep;
+        if (name == "zipf") {
+            double theta;
+            if (stream >> theta && stream.eof() && theta >= 0.)
+                return theta > 0. ? KeyDistribution{Kind::zipf, theta} : KeyDistribution{};
+        } else if (name == "hotspot") {
+            double keys, prob;
+            if (stream >> keys >> sep >> prob && sep == ':' && stream.eof() && keys > 0. && keys <= 1. && prob >= 0. && prob <= 1.)
+                return KeyDistribution{Kind::hotspot, 0., keys, prob};
+        }
+        ::std::cerr << "Invalid key distribution '" << spec << "' (expected 'uniform', 'zipf:<θ>' or 'hotspot:<fraction of keys>:<probability of access>')" << ::std::endl;
+        throw Exception::ArgumentValue{};
+    }
+    /** Print a description of the distribution.
+     * @param os Output stream
+     * @param kd Distribution to describe
+     * @return Output stream
+    **/
+    friend ::std::ostream& operator<<(::std::ostream& os, KeyDistribution const& kd) {
+        switch (kd.kind) {
+        case Kind::zipf:
+            return os << "zipf (θ = " << kd.theta << ")";
+        case Kind::hotspot:
+            return os << "hotspot (" << (kd.hot_prob * 100.) << "% of the accesses on " << (kd.hot_keys * 100.) << "% of the keys)";
+        default:
+            return os << "uniform";
+        }
+    }
+public:
+    /** Draw a key index, the instance caching per-'n' constants (use one copy per thread).
+     * @param engine Randomness source
+     * @param n      Non-null number of keys
+     * @return Drawn index in [0, n[
+    **/
+    template<class Engine> size_t operator()(Engine& engine, size_t n) {
+        switch (kind) {
+        case Kind::zipf:
+            return zipf(engine, n);
+        case Kind::hotspot: {
+            auto hot = static_cast<size_t>(::std::llround(hot_keys * static_cast<double>(n)));
+            if (hot < 1)
+                hot = 1;
+            if (hot >= n || ::std::bernoulli_distribution{hot_prob}(engine))
+                return ::std::uniform_int_distribution<size_t>{0, hot - 1}(engine);
+            return ::std::uniform_int_distribution<size_t>{hot, n - 1}(engine);
+        }
+        default:
+            return ::std::uniform_int_distribution<size_t>{0, n - 1}(engine);
+        }
+    }
+};
+
+/** Cheap inline random engine (SplitMix64), for the draws left in the measured loops.
+**/
+class FastEngine final {
+private:
+    uint64_t state; // Generator state
+public:
+    using result_type = uint64_t;
+    /** Seed constructor.
+     * @param seed Seed to use
+    **/
+    explicit FastEngine(uint64_t seed) noexcept: state{seed} {}
+public:
+    /** Get the range of the generated values.
+     * @return Smallest or largest generated value
+    **/
+    constexpr static result_type min() noexcept {
+        return 0;
+    }
+    constexpr static result_type max() noexcept {
+        return UINT64_MAX;
+    }
+    /** Generate the next value.
+     * @return Uniformly distributed value
+    **/
+    result_type operator()() noexcept {
+        auto z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
+
+/** Fixed-size latency histogram class, log-linear: exact below 32 ns, then 16 buckets per power of two (less than 1/16 of relative error).
+**/
+class LatencyHistogram final {
+public:
+    constexpr static size_t nbsubs    = 16;               // Buckets per power of two
+    constexpr static size_t nbbuckets = (64 - 3) * nbsubs; // Buckets covering every 64-bit value
+private:
+    ::std::array<uint64_t, nbbuckets> counts; // Number of values in each bucket
+    uint64_t     count; // Number of values
+    Chrono::Tick max;   // Largest value
+private:
+    /** Get the bucket of a value.
+     * @param value Value
+     * @return Bucket index
+    **/
+    static size_t bucket(Chrono::Tick value) noexcept {
+        if (value < nbsubs)
+            return static_cast<size_t>(value);
+        auto const exp = static_cast<size_t>(63 - __builtin_clzll(static_cast<unsigned long long>(value))); // At least 4
+        return (exp - 3) * nbsubs + static_cast<size_t>((value >> (exp - 4)) & (nbsubs - 1));
+    }
+    /** Get the middle value of a bucket.
+     * @param index Bucket index
+     * @return Middle value
+    **/
+    static double middle(size_t index) noexcept {
+        if (index < nbsubs)
+            return static_cast<double>(index);
+        auto const shift = index / nbsubs - 1;
+        auto const low   = static_cast<double>((nbsubs + index % nbsubs) << shift);
+        return low + static_cast<double>((Chrono::Tick{1} << shift) - 1) / 2.;
+    }
+public:
+    /** Empty histogram constructor.
+    **/
+    LatencyHistogram(): counts{}, count{0}, max{0} {}
+public:
+    /** Add a value.
+     * @param value Value to add (in ns)
+    **/
+    void add(Chrono::Tick value) noexcept {
+        ++counts[bucket(value)];
+        ++count;
+        max = ::std::max(max, value);
+    }
+    /** Add the values of another histogram.
+     * @param other Histogram to merge
+    **/
+    void merge(LatencyHistogram const& other) noexcept {
+        for (size_t i = 0; i < nbbuckets; ++i)
+            counts[i] += other.counts[i];
+        count += other.count;
+        max = ::std::max(max, other.max);
+    }
+    /** Get the number of values.
+     * @return Number of values
+    **/
+    auto get_count() const noexcept {
+        return count;
+    }
+    /** Get the largest value.
+     * @return Largest value (in ns), 0 if empty
+    **/
+    auto get_max() const noexcept {
+        return max;
+    }
+    /** Get the given quantile, as the middle of the bucket holding the value of its rank.
+     * @param level Quantile level in [0, 1]
+     * @return Quantile (in ns), 0 if empty
+    **/
+    double quantile(double level) const noexcept {
+        if (count == 0)
+            return 0.;
+        auto const rank = ::std::max<uint64_t>(static_cast<uint64_t>(::std::ceil(level * static_cast<double>(count))), 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < nbbuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank)
+                return ::std::min(middle(i), static_cast<double>(max));
+        }
+        return static_cast<double>(max);
+    }
+};
+
+/** Open-loop arrival schedule class, pacing the operations of one worker on a Poisson process and recording their latency from their scheduled arrival.
+ * An inactive schedule (closed loop) neither waits nor records anything.
+**/
+class Arrivals final {
+private:
+    LatencyHistogram*        latencies; // Latencies of the operations (in ns), 'nullptr' if inactive
+    ::std::minstd_rand              engine; // Inter-arrival random engine
+    ::std::exponential_distribution<double> gap; // Inter-arrival time (in ns)
+    CycleChrono                      clock; // Time since the start of the schedule, read twice per operation
+    double                            next; // Scheduled arrival of the next operation (in ns since the start)
+public:
+    /** Schedule constructor, starting the schedule.
+     * @param latencies Latency histogram to add to, 'nullptr' for an inactive schedule
+     * @param rate      Arrival rate (in operations per second)
+     * @param seed      Seed of the inter-arrival times
+    **/
+    Arrivals(LatencyHistogram* latencies, double rate, Seed seed): latencies{latencies}, engine{seed}, gap{rate > 0. ? rate / 1000000000. : 1.}, next{0.} {
+        if (latencies) {
+            next = gap(engine);
+            clock.start();
+        }
+    }
+public:
+    /** Wait for the scheduled arrival of the next operation, returning immediately if late.
+    **/
+    void arrive() {
+        if (!latencies)
+            return;
+        while (true) {
+            auto const ahead = next - static_cast<double>(clock.delta());
+            if (ahead <= 0.)
+                return;
+            if (ahead > 100000.) { // Sleep while well ahead, spin (yielding) close to the arrival
+                ::std::this_thread::sleep_for(::std::chrono::nanoseconds{static_cast<Chrono::Tick>(ahead) - 50000});
+            } else {
+                ::std::this_thread::yield();
+            }
+        }
+    }
+    /** Record the completion of the current operation, and schedule the next one.
+    **/
+    void depart() {
+        if (!latencies)
+            return;
+        auto const now = static_cast<double>(clock.delta());
+        latencies->add(static_cast<Chrono::Tick>(now > next ? now - next : 0.));
+        next += gap(engine);
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
 /** Workload base class.
 **/
 class Workload {
 protected:
     TransactionalLibrary const& tl;  // Associated transactional library
     TransactionalMemory         tm;  // Built transactional memory to use
+private:
+    double rate; // Per-worker open-loop arrival rate (in operations per second), 0 for closed-loop runs
+    ::std::unique_ptr<LatencyHistogram[]> latencies; // Per-worker latencies of the open-loop operations, of fixed size
+    size_t nbopenworkers; // Number of per-worker latency histograms
+protected:
+    /** [thread-safe] Get the arrival schedule of a worker's run, inactive in closed-loop mode.
+     * @param uid  Worker unique ID
+     * @param seed Seed of the run
+     * @return Arrival schedule, to call around each operation
+    **/
+    Arrivals arrivals(Uid uid, Seed seed) const {
+        return Arrivals{rate > 0. ? &latencies[uid] : nullptr, rate, seed ^ 0x5bd1e995u};
+    }
 public:
     /** Deleted copy constructor/assignment.
     **/
@@ -56,7 +404,7 @@ public:
      * @param align   Shared memory region required alignment
      * @param size    Size of the shared memory region to allocate
     **/
-    Workload(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, tm{tl, align, size} {}
+    Workload(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, tm{tl, align, size}, rate{0.}, nbopenworkers{0} {}
     /** Virtual destructor.
     **/
     virtual ~Workload() {};
@@ -65,6 +413,14 @@ public:
      * @return Constant null-terminated error message, 'nullptr' for none
     **/
     virtual char const* init() const = 0;
+    /** [thread-safe] Worker's untimed preparation of its next run, e.g. pre-generating its random decisions (nothing by default).
+     * @param Unique ID (between 0 to n-1)
+     * @param Seed the run will use
+     * @return Constant null-terminated error message, 'nullptr' for none
+    **/
+    virtual char const* prepare(Uid, Seed) const {
+        return nullptr;
+    }
     /** [thread-safe] Worker's full run.
      * @param Unique ID (between 0 to n-1)
      * @param Seed to use
@@ -77,6 +433,41 @@ public:
      * @return Constant null-terminated error message, 'nullptr' for none
     **/
     virtual char const* check(Uid, Seed) const = 0;
+    /** Print workload-specific statistics of the performance measurements, as "⎪ "-prefixed lines (none by default).
+     * @param Total duration of the measured runs (in s)
+    **/
+    virtual void report(double) const {}
+public:
+    /** Switch to open-loop runs, each worker's operations arriving on a Poisson process.
+     * @param nbworkers Number of concurrent workers
+     * @param rate      Per-worker arrival rate (in operations per second), 0 for closed-loop runs
+    **/
+    void set_open_loop(size_t nbworkers, double rate) {
+        this->rate = rate;
+        latencies.reset(rate > 0. ? new LatencyHistogram[nbworkers] : nullptr);
+        nbopenworkers = rate > 0. ? nbworkers : 0;
+    }
+    /** Get the amount of user data held in the shared memory, to which the footprint of the library is compared (the first segment by default).
+     * @return Size of the user data (in bytes)
+    **/
+    virtual size_t get_user_size() const noexcept {
+        return tm.get_size();
+    }
+    /** Tell whether the workers' runs can be run one after the other by a single thread, i.e. no run waits for another worker (true by default).
+     * @return Whether the runs can be serialized
+    **/
+    virtual bool can_run_serially() const noexcept {
+        return true;
+    }
+    /** Get the latencies of all the open-loop operations run so far.
+     * @return Latency histogram, empty in closed-loop mode
+    **/
+    LatencyHistogram get_latencies() const {
+        LatencyHistogram res;
+        for (size_t i = 0; i < nbopenworkers; ++i)
+            res.merge(latencies[i]);
+        return res;
+    }
 };
 
 // -------------------------------------------------------------------------- //
@@ -140,7 +531,25 @@ private:
     Balance init_balance;  // Initial account balance
     float   prob_long;     // Probability of running a long, read-only control transaction
     float   prob_alloc;    // Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+    float   prob_read;     // Probability of running a short read-only transaction instead of a transfer, knowing neither a long nor an allocation transaction will run
+    KeyDistribution keys;  // Distribution of the sender and receiver accounts of short transactions
     Barrier barrier;       // Barrier for thread synchronization during 'check'
+    /** Pre-generated random decisions of one worker's run.
+    **/
+    struct Decisions {
+        Seed                    seed;     // Seed they were generated from
+        ::std::vector<uint8_t>  kinds;    // Kind of each transaction, in 'Kind'
+        ::std::vector<float>    triggers; // Allocation trigger of each allocation transaction, in order
+    };
+    /** Transaction kind enum.
+    **/
+    enum Kind: uint8_t {
+        kind_long,     // Long read-only transaction
+        kind_alloc,    // Allocation/deallocation transaction
+        kind_read,     // Short read-only transaction
+        kind_transfer  // Short read-write transaction
+    };
+    ::std::unique_ptr<Decisions[]> mutable decisions; // Per-worker pre-generated decisions
 public:
     /** Bank workload constructor.
      * @param library       Transactional library to use
@@ -151,8 +560,10 @@ public:
      * @param init_balance  Initial account balance
      * @param prob_long     Probability of running a long, read-only control transaction
      * @param prob_alloc    Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+     * @param prob_read     Probability of running a short read-only transaction instead of a transfer (optional)
+     * @param keys          Distribution of the sender and receiver accounts of short transactions (optional)
     **/
-    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, barrier{static_cast<Barrier::Counter>(nbworkers)} {}
+    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc, float prob_read = 0.f, KeyDistribution keys = {}): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, prob_read{prob_read}, keys{keys}, barrier{static_cast<Barrier::Counter>(nbworkers)}, decisions{new Decisions[nbworkers]()} {}
 private:
     /** Long read-only transaction, summing the balance of each account.
      * @param count Loosely-updated number of accounts
@@ -224,6 +635,60 @@ private:
             }
         });
     }
+    /** Get the addresses of two accounts, walking the segments.
+     * @param tx       Associated pending transaction
+     * @param send_id  Index of the first account
+     * @param recv_id  Index of the second account (potentially same as the first)
+     * @param send_ptr Address of the first account (output)
+     * @param recv_ptr Address of the second account (output)
+     * @return Whether both accounts exist
+    **/
+    bool locate(Transaction& tx, size_t send_id, size_t recv_id, void*& send_ptr, void*& recv_ptr) const {
+        send_ptr = nullptr;
+        recv_ptr = nullptr;
+        auto start = tm.get_start();
+        while (true) {
+            AccountSegment segment{tx, start};
+            size_t segment_count = segment.count;
+            if (!send_ptr) {
+                if (send_id < segment_count) {
+                    send_ptr = segment.accounts[send_id].get();
+                    if (recv_ptr)
+                        return true;
+                } else {
+                    send_id -= segment_count;
+                }
+            }
+            if (!recv_ptr) {
+                if (recv_id < segment_count) {
+                    recv_ptr = segment.accounts[recv_id].get();
+                    if (send_ptr)
+                        return true;
+                } else {
+                    recv_id -= segment_count;
+                }
+            }
+            start = segment.next;
+            if (!start) // Current segment is the last segment
+                return false;
+        }
+    }
+    /** Short read-only transaction, reading the balance of two accounts (potentially the same).
+     * @param send_id Index of the first account
+     * @param recv_id Index of the second account (potentially same as the first)
+     * @param correct Set to whether both balances were non-negative (output)
+     * @return Whether the parameters were satisfying
+    **/
+    bool read_tx(size_t send_id, size_t recv_id, bool& correct) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            void* send_ptr;
+            void* recv_ptr;
+            if (!locate(tx, send_id, recv_id, send_ptr, recv_ptr))
+                return false;
+            correct = Shared<Balance>{tx, send_ptr}.read() >= 0 && Shared<Balance>{tx, recv_ptr}.read() >= 0;
+            return true;
+        });
+    }
     /** Short read-write transaction, transferring one unit from an account to an account (potentially the same).
      * @param send_id Index of the sender account
      * @param recv_id Index of the receiver account (potentially same as source)
@@ -231,36 +696,11 @@ private:
     **/
     bool short_tx(size_t send_id, size_t recv_id) const {
         return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
-            void* send_ptr = nullptr;
-            void* recv_ptr = nullptr;
-
             // Get the account pointers in shared memory
-            auto start = tm.get_start();
-            while (true) {
-                AccountSegment segment{tx, start};
-                size_t segment_count = segment.count;
-                if (!send_ptr) {
-                    if (send_id < segment_count) {
-                        send_ptr = segment.accounts[send_id].get();
-                        if (recv_ptr)
-                            break;
-                    } else {
-                        send_id -= segment_count;
-                    }
-                }
-                if (!recv_ptr) {
-                    if (recv_id < segment_count) {
-                        recv_ptr = segment.accounts[recv_id].get();
-                        if (send_ptr)
-                            break;
-                    } else {
-                        recv_id -= segment_count;
-                    }
-                }
-                start = segment.next;
-                if (!start) // Current segment is the last segment
-                    return false; // At least one account does not exist => do nothing
-            }
+            void* send_ptr;
+            void* recv_ptr;
+            if (!locate(tx, send_id, recv_id, send_ptr, recv_ptr))
+                return false; // At least one account does not exist => do nothing
 
             // Transfer the money if enough fund
             Shared<Balance> sender{tx, send_ptr}; // Shared is a template that overloads copy to use tm_read/tm_write.
@@ -294,25 +734,63 @@ public:
     }
 
     /**
-     * Run nbtxperwrk random transactions until completion.
-     * @param seed Randomness source
+     * Pre-generate the kind of each transaction of a run, and the trigger of each allocation transaction.
+     * @param uid  Id of the worker
+     * @param seed Randomness source of the run
     **/
-    virtual char const* run(Uid uid [[gnu::unused]], Seed seed) const {
+    virtual char const* prepare(Uid uid, Seed seed) const {
         ::std::minstd_rand engine{seed};
         ::std::bernoulli_distribution long_dist{prob_long};
         ::std::bernoulli_distribution alloc_dist{prob_alloc};
+        ::std::bernoulli_distribution read_dist{prob_read};
         ::std::gamma_distribution<float> alloc_trigger(expnbaccounts, 1);
-        size_t count = nbaccounts;
-        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+        auto&& res = decisions[uid];
+        res.seed = seed;
+        res.kinds.resize(nbtxperwrk);
+        res.triggers.clear();
+        for (auto&& kind: res.kinds) {
             if (long_dist(engine)) { // We roll a dice and, if "lucky", run a long transaction.
-                if (unlikely(!long_tx(count))) // If it fails, then we return an error message.
-                    return "Violated isolation or atomicity";
+                kind = kind_long;
             } else if (alloc_dist(engine)) { // Let's roll a dice again to trigger an allocation transaction.
-                alloc_tx(alloc_trigger(engine));
+                kind = kind_alloc;
+                res.triggers.push_back(alloc_trigger(engine));
+            } else if (prob_read > 0.f && read_dist(engine)) { // Then maybe a short read-only transaction.
+                kind = kind_read;
             } else { // No luck with previous rolls, let's just run a short transaction.
-                ::std::uniform_int_distribution<size_t> account{0, count - 1};
-                while (unlikely(!short_tx(account(engine), account(engine))));
+                kind = kind_transfer;
+            }
+        }
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk random transactions until completion, their kinds pre-generated by 'prepare' (called here if it was not).
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        auto&& decided = decisions[uid];
+        if (unlikely(decided.seed != seed || decided.kinds.size() != nbtxperwrk))
+            prepare(uid, seed);
+        FastEngine engine{seed};
+        auto account = keys; // Private copy, as it caches per-count constants
+        auto trigger = decided.triggers.cbegin();
+        size_t count = nbaccounts;
+        auto pacer = arrivals(uid, seed);
+        for (auto kind: decided.kinds) {
+            pacer.arrive();
+            if (kind == kind_long) {
+                if (unlikely(!long_tx(count))) // If it fails, then we return an error message.
+                    return "Violated isolation or atomicity";
+            } else if (kind == kind_alloc) {
+                alloc_tx(*(trigger++));
+            } else if (kind == kind_read) {
+                bool correct;
+                while (unlikely(!read_tx(account(engine, count), account(engine, count), correct)));
+                if (unlikely(!correct))
+                    return "Violated isolation or atomicity";
+            } else {
+                while (unlikely(!short_tx(account(engine, count), account(engine, count))));
             }
+            pacer.depart();
         }
         { // Last long transaction
             size_t dummy;
@@ -321,6 +799,12 @@ public:
         }
         return nullptr;
     }
+    /** Get the amount of user data, i.e. the expected number of account segments.
+     * @return Size of the user data (in bytes)
+    **/
+    virtual size_t get_user_size() const noexcept {
+        return (expnbaccounts + nbaccounts - 1) / nbaccounts * AccountSegment::size(nbaccounts);
+    }
     /**
      * Test in which we check that multiple concurrent transactions can decrease a counter in a sequential manner.
      * @param uid Id of the thread to run the check
@@ -387,3 +871,2747 @@ public:
         return nullptr;
     }
 };
+
+// -------------------------------------------------------------------------- //
+
+/** Hash map workload class, an open-addressing (linear probing) map in the first segment.
+**/
+class WorkloadHashMap final: public Workload {
+public:
+    /** Key and value class aliases, a value always being congruent to its key modulo the number of keys.
+    **/
+    using Key   = uintptr_t;
+    using Value = uintptr_t;
+    constexpr static auto empty = ~Key{0}; // Key of an empty slot
+private:
+    /** Shared slot class.
+    **/
+    class Slot final {
+    public:
+        /** Get the slot size.
+         * @return Slot size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Key) + sizeof(Value);
+        }
+    public:
+        Shared<Key>   key;   // Key, 'empty' if the slot is free
+        Shared<Value> value; // Associated value (undefined if the slot is free)
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Slot(Slot const&) = delete;
+        Slot& operator=(Slot const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Slot base address
+        **/
+        Slot(Transaction& tx, void* address): key{tx, address}, value{tx, key.after()} {}
+    };
+private:
+    size_t          nbworkers;   // Number of concurrent workers
+    size_t          nbtxperwrk;  // Number of transactions per worker
+    size_t          nbkeys;      // Number of distinct keys, half of them initially in the map
+    size_t          nbslots;     // Number of slots (power of 2, at least twice the number of keys)
+    float           prob_update; // Probability of running a put or delete (evenly), instead of a get
+    KeyDistribution keys;        // Distribution of the accessed keys
+    ::std::unique_ptr<ptrdiff_t[]> deltas; // Per-worker net number of inserted keys since initialization
+    ::std::atomic_flag mutable initialized = ATOMIC_FLAG_INIT; // Whether a worker already took care of the initialization
+private:
+    /** Compute the slot count for a given number of keys.
+     * @param nbkeys Number of distinct keys
+     * @return Number of slots
+    **/
+    constexpr static size_t slots(size_t nbkeys) noexcept {
+        size_t res = 2;
+        while (res < 2 * nbkeys)
+            res *= 2;
+        return res;
+    }
+    /** Get the home slot of a key.
+     * @param key Key to hash
+     * @return Home slot index
+    **/
+    size_t home(Key key) const noexcept {
+        uint64_t res = key + 0x9e3779b97f4a7c15ull; // SplitMix64 finalizer
+        res = (res ^ (res >> 30)) * 0xbf58476d1ce4e5b9ull;
+        res = (res ^ (res >> 27)) * 0x94d049bb133111ebull;
+        return static_cast<size_t>(res ^ (res >> 31)) & (nbslots - 1);
+    }
+    /** Get the address of a slot.
+     * @param index Slot index
+     * @return Slot address in shared memory
+    **/
+    void* slot(size_t index) const noexcept {
+        return reinterpret_cast<char*>(tm.get_start()) + index * Slot::size();
+    }
+    /** Check whether a slot lies cyclically in ]from, to].
+    **/
+    static bool between(size_t from, size_t index, size_t to) noexcept {
+        return from <= to ? from < index && index <= to : from < index || index <= to;
+    }
+public:
+    /** Hash map workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbkeys      Number of distinct keys, half of them initially in the map
+     * @param prob_update Probability of running a put or delete (evenly), instead of a get
+     * @param keys        Distribution of the accessed keys
+    **/
+    WorkloadHashMap(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, float prob_update, KeyDistribution keys): Workload{library, alignof(Key), slots(nbkeys) * Slot::size()}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbkeys{nbkeys}, nbslots{slots(nbkeys)}, prob_update{prob_update}, keys{keys}, deltas{new ptrdiff_t[nbworkers]()} {}
+private:
+    /** Read-only lookup transaction.
+     * @param key Key to look up
+     * @return Whether no inconsistency has been found
+    **/
+    bool get_tx(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            for (auto index = home(key);; index = (index + 1) & (nbslots - 1)) {
+                Slot slot{tx, this->slot(index)};
+                Key found = slot.key;
+                if (found == empty) // Not in the map
+                    return true;
+                if (found == key)
+                    return slot.value.read() % nbkeys == key; // Value must belong to the key
+            }
+        });
+    }
+    /** Read-write insertion or update transaction.
+     * @param key   Key to insert or update
+     * @param value Associated value
+     * @return Whether the key was inserted (i.e. not already present)
+    **/
+    bool put_tx(Key key, Value value) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            for (auto index = home(key);; index = (index + 1) & (nbslots - 1)) {
+                Slot slot{tx, this->slot(index)};
+                Key found = slot.key;
+                if (found == key) { // Update
+                    slot.value = value;
+                    return false;
+                }
+                if (found == empty) { // Insert
+                    slot.key   = key;
+                    slot.value = value;
+                    return true;
+                }
+            }
+        });
+    }
+    /** Read-write deletion transaction, shifting back the following slots of the cluster (no tombstone).
+     * @param key Key to delete
+     * @return Whether the key was deleted (i.e. present)
+    **/
+    bool delete_tx(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto hole = home(key);
+            for (;; hole = (hole + 1) & (nbslots - 1)) { // Find the key
+                Key found = Slot{tx, slot(hole)}.key;
+                if (found == empty)
+                    return false;
+                if (found == key)
+                    break;
+            }
+            for (auto index = (hole + 1) & (nbslots - 1);; index = (index + 1) & (nbslots - 1)) { // Fill the hole with a following entry that may move there
+                Slot next{tx, slot(index)};
+                Key moved = next.key;
+                if (moved == empty)
+                    break;
+                if (between(hole, home(moved), index)) // Entry is between its home and the hole, cannot move
+                    continue;
+                Slot dest{tx, slot(hole)};
+                dest.key   = moved;
+                dest.value = next.value.read();
+                hole = index;
+            }
+            Slot{tx, slot(hole)}.key = empty;
+            return true;
+        });
+    }
+public:
+    /**
+     * Initialize the map with the even keys, in one transaction run by the first worker only.
+    **/
+    virtual char const* init() const {
+        if (initialized.test_and_set(::std::memory_order_relaxed))
+            return nullptr;
+        ::std::unique_ptr<Key[]> layout{new Key[nbslots]};
+        for (size_t i = 0; i < nbslots; ++i)
+            layout[i] = empty;
+        for (Key key = 0; key < nbkeys; key += 2) {
+            auto index = home(key);
+            while (layout[index] != empty)
+                index = (index + 1) & (nbslots - 1);
+            layout[index] = key;
+        }
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            for (size_t i = 0; i < nbslots; ++i) {
+                Slot slot{tx, this->slot(i)};
+                slot.key = layout[i];
+                if (layout[i] != empty)
+                    slot.value = layout[i];
+            }
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            return Slot{tx, slot(home(0))}.key.read() != empty;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk random lookups, insertions/updates and deletions.
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution put_dist{0.5};
+        ::std::uniform_int_distribution<Value> stamp_dist{0, (Value{1} << 20) - 1};
+        auto key = keys; // Private copy, as it caches per-count constants
+        ptrdiff_t delta = 0;
+        auto pacer = arrivals(uid, seed);
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            pacer.arrive();
+            Key k = key(engine, nbkeys);
+            if (!update_dist(engine)) {
+                if (unlikely(!get_tx(k)))
+                    return "Violated isolation or atomicity";
+            } else if (put_dist(engine)) {
+                if (put_tx(k, k + nbkeys * stamp_dist(engine)))
+                    ++delta;
+            } else {
+                if (delete_tx(k))
+                    --delta;
+            }
+            pacer.depart();
+        }
+        deltas[uid] += delta;
+        return nullptr;
+    }
+    /**
+     * Check the map structure and contents in one read-only transaction.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        ::std::unique_ptr<Key[]> layout{new Key[nbslots]};
+        ::std::unique_ptr<Value[]> values{new Value[nbslots]};
+        transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            for (size_t i = 0; i < nbslots; ++i) {
+                Slot slot{tx, this->slot(i)};
+                layout[i] = slot.key;
+                if (layout[i] != empty)
+                    values[i] = slot.value;
+            }
+        });
+        ::std::vector<bool> seen(nbkeys, false);
+        ptrdiff_t count = 0;
+        for (size_t i = 0; i < nbslots; ++i) {
+            auto key = layout[i];
+            if (key == empty)
+                continue;
+            if (unlikely(key >= nbkeys || seen[key]))
+                return "Violated consistency (unknown or duplicate key in the hash map)";
+            if (unlikely(values[i] % nbkeys != key))
+                return "Violated isolation or atomicity (value not matching its key in the hash map)";
+            for (auto index = home(key); index != i; index = (index + 1) & (nbslots - 1)) { // Must be reachable from its home slot
+                if (unlikely(layout[index] == empty))
+                    return "Violated isolation or atomicity (unreachable key in the hash map)";
+            }
+            seen[key] = true;
+            ++count;
+        }
+        auto expected = static_cast<ptrdiff_t>((nbkeys + 1) / 2);
+        for (size_t i = 0; i < nbworkers; ++i)
+            expected += deltas[i];
+        if (unlikely(count != expected))
+            return "Violated atomicity (number of keys in the hash map not matching the committed insertions and deletions)";
+        return nullptr;
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Shared node pool class, handing out fixed-size nodes either carved out of the first segment or allocated one segment each.
+**/
+class NodePool final {
+public:
+    /** Node allocation mode class.
+    **/
+    enum class Mode {
+        pool,   // Nodes preallocated in the first segment, kept in per-worker transactional free lists
+        segment // One 'tm_alloc'/'tm_free' per node (some libraries cap their number of segments)
+    };
+private:
+    Mode   mode;      // Allocation mode
+    size_t nbworkers; // Number of free lists, one per worker
+    size_t node_size; // Size of a node (in bytes)
+    size_t nbnodes;   // Number of preallocated nodes (pool mode)
+    size_t offset;    // Offset of the pool in the first segment (in bytes)
+private:
+    /** Get the address of the free list head of a worker.
+     * @param tx  Associated pending transaction
+     * @param uid Worker unique ID
+     * @return Free list head address
+    **/
+    void* head(Transaction& tx, size_t uid) const noexcept {
+        return reinterpret_cast<char*>(tx.get_tm().get_start()) + offset + uid * sizeof(void*);
+    }
+    /** Get the address of a preallocated node.
+     * @param tx    Associated pending transaction
+     * @param index Node index
+     * @return Node address
+    **/
+    void* node(Transaction& tx, size_t index) const noexcept {
+        return reinterpret_cast<char*>(head(tx, nbworkers)) + index * node_size;
+    }
+public:
+    /** Pool constructor.
+     * @param mode      Allocation mode
+     * @param nbworkers Number of concurrent workers
+     * @param node_size Size of a node (in bytes, at least a pointer, multiple of the pointer alignment)
+     * @param nbnodes   Number of preallocated nodes (pool mode), i.e. maximum number of live nodes
+     * @param offset    Offset of the pool in the first segment (in bytes, multiple of the pointer alignment)
+    **/
+    NodePool(Mode mode, size_t nbworkers, size_t node_size, size_t nbnodes, size_t offset) noexcept: mode{mode}, nbworkers{nbworkers}, node_size{node_size}, nbnodes{mode == Mode::pool ? nbnodes : 0}, offset{offset} {}
+public:
+    /** Get the size a pool takes in the first segment.
+     * @param mode      Allocation mode
+     * @param nbworkers Number of concurrent workers
+     * @param node_size Size of a node (in bytes)
+     * @param nbnodes   Number of preallocated nodes (pool mode)
+     * @return Pool size (in bytes)
+    **/
+    constexpr static size_t size(Mode mode, size_t nbworkers, size_t node_size, size_t nbnodes) noexcept {
+        return nbworkers * sizeof(void*) + (mode == Mode::pool ? nbnodes * node_size : 0);
+    }
+    /** Get the number of preallocated nodes.
+     * @return Number of preallocated nodes, 0 in segment mode
+    **/
+    auto get_nbnodes() const noexcept {
+        return nbnodes;
+    }
+    /** Thread the preallocated nodes into the free lists, evenly across workers.
+     * @param tx Associated pending transaction
+    **/
+    void init(Transaction& tx) const {
+        for (size_t uid = 0; uid < nbworkers; ++uid)
+            Shared<void*>{tx, head(tx, uid)} = nullptr;
+        for (size_t i = 0; i < nbnodes; ++i) {
+            Shared<void*> list{tx, head(tx, i % nbworkers)};
+            Shared<void*>{tx, node(tx, i)} = list.read();
+            list = node(tx, i);
+        }
+    }
+    /** Allocate a node, from the worker's free list first then from the other ones, throw 'Exception::TransactionAlloc' if the pool is exhausted.
+     * @param tx  Associated pending transaction
+     * @param uid Worker unique ID
+     * @return Node address, content undefined
+    **/
+    void* alloc(Transaction& tx, Uid uid) const {
+        auto res = try_alloc(tx, uid);
+        if (unlikely(!res))
+            throw Exception::TransactionAlloc{};
+        return res;
+    }
+    /** Allocate a node, from the worker's free list first then from the other ones, if any is left.
+     * @param tx  Associated pending transaction
+     * @param uid Worker unique ID
+     * @return Node address, content undefined, 'nullptr' if the pool is exhausted
+    **/
+    void* try_alloc(Transaction& tx, Uid uid) const {
+        if (mode == Mode::segment)
+            return tx.alloc(node_size);
+        for (size_t i = 0; i < nbworkers; ++i) {
+            Shared<void*> list{tx, head(tx, (uid + i) % nbworkers)};
+            void* res = list;
+            if (res) {
+                list = Shared<void*>{tx, res}.read();
+                return res;
+            }
+        }
+        return nullptr;
+    }
+    /** Free a node, into the worker's free list.
+     * @param tx     Associated pending transaction
+     * @param uid    Worker unique ID
+     * @param target Node address
+    **/
+    void free(Transaction& tx, Uid uid, void* target) const {
+        if (mode == Mode::segment)
+            return tx.free(target);
+        Shared<void*> list{tx, head(tx, uid)};
+        Shared<void*>{tx, target} = list.read();
+        list = target;
+    }
+    /** Collect the free nodes.
+     * @param tx Associated pending transaction
+     * @return Free node addresses (empty in segment mode)
+    **/
+    ::std::vector<void*> free_nodes(Transaction& tx) const {
+        ::std::vector<void*> res;
+        if (mode == Mode::segment)
+            return res;
+        for (size_t uid = 0; uid < nbworkers; ++uid) {
+            for (void* cur = Shared<void*>{tx, head(tx, uid)}; cur && res.size() <= nbnodes; cur = Shared<void*>{tx, cur}.read())
+                res.push_back(cur);
+        }
+        return res;
+    }
+    /** Check whether an address is the one of a preallocated node.
+     * @param tx      Associated pending transaction
+     * @param address Address to check
+     * @return Whether the address is a preallocated node (always true in segment mode)
+    **/
+    bool owns(Transaction& tx, void* address) const noexcept {
+        if (mode == Mode::segment)
+            return true;
+        auto const base = reinterpret_cast<uintptr_t>(node(tx, 0));
+        auto const addr = reinterpret_cast<uintptr_t>(address);
+        return addr >= base && addr < base + nbnodes * node_size && (addr - base) % node_size == 0;
+    }
+public:
+    /** Parse an allocation mode, throw 'Exception::ArgumentValue' if unknown.
+     * @param name Mode name, 'pool' or 'segment'
+     * @return Allocation mode
+    **/
+    static Mode parse(::std::string const& name) {
+        if (name == "pool")
+            return Mode::pool;
+        if (name == "segment")
+            return Mode::segment;
+        throw Exception::ArgumentValue{"unknown node allocation mode (expected 'pool' or 'segment')"};
+    }
+    /** Get the name of an allocation mode.
+     * @param mode Allocation mode
+     * @return Null-terminated mode name
+    **/
+    static char const* name(Mode mode) noexcept {
+        return mode == Mode::pool ? "pool" : "segment";
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Skip list workload class, a sorted set of keys whose nodes come from a node pool (a single level making it a sorted linked list).
+**/
+class WorkloadSkipList final: public Workload {
+public:
+    /** Key class alias.
+    **/
+    using Key = uintptr_t;
+    constexpr static size_t max_levels = 32; // Maximum number of levels
+private:
+    /** Shared node class.
+    **/
+    class Node final {
+    public:
+        /** Get the node size for a given number of levels.
+         * @param nblevels Number of levels
+         * @return Node size (in bytes)
+        **/
+        constexpr static auto size(size_t nblevels) noexcept {
+            return sizeof(Key) + nblevels * sizeof(Node*);
+        }
+    public:
+        Shared<Key>     key;  // Key (undefined for the head node)
+        Shared<Node*[]> next; // Successor at each level, up to the node's height
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Node(Node const&) = delete;
+        Node& operator=(Node const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Node base address
+        **/
+        Node(Transaction& tx, void* address): key{tx, address}, next{tx, key.after()} {}
+    };
+private:
+    size_t          nbworkers;   // Number of concurrent workers
+    size_t          nbtxperwrk;  // Number of transactions per worker
+    size_t          nbkeys;      // Number of distinct keys, half of them initially in the set
+    size_t          nblevels;    // Number of levels, 1 for a sorted linked list
+    float           prob_update; // Probability of running an insertion or deletion (evenly), instead of a lookup
+    KeyDistribution keys;        // Distribution of the accessed keys
+    NodePool        pool;        // Node pool, right after the head node in the first segment
+    ::std::unique_ptr<ptrdiff_t[]> deltas; // Per-worker net number of inserted keys since initialization
+    ::std::atomic_flag mutable initialized = ATOMIC_FLAG_INIT; // Whether a worker already took care of the initialization
+private:
+    /** Search the predecessors of a key at each level.
+     * @param tx    Associated pending transaction
+     * @param key   Key to search
+     * @param preds Predecessor at each level (output, may be 'nullptr' if only the level 0 matters)
+     * @param sane  Set to whether the traversed keys were increasing and no level was longer than the key range (output)
+     * @return Node holding the key, 'nullptr' if absent
+    **/
+    Node* search(Transaction& tx, Key key, void** preds, bool& sane) const {
+        void* pred = tm.get_start(); // Head node
+        Node* succ = nullptr;
+        auto first = true; // Whether 'pred' is the head node
+        Key last = 0; // Key of 'pred', if not the head node
+        size_t hops = 0;
+        sane = true;
+        for (auto level = nblevels; level-- > 0;) {
+            while (true) {
+                succ = Node{tx, pred}.next[level];
+                if (!succ)
+                    break;
+                Key found = Node{tx, succ}.key;
+                if (unlikely((!first && found <= last) || ++hops > nblevels * nbkeys)) {
+                    sane = false;
+                    return nullptr;
+                }
+                if (found >= key)
+                    break;
+                pred  = succ;
+                first = false;
+                last  = found;
+            }
+            if (preds)
+                preds[level] = pred;
+        }
+        return succ && Node{tx, succ}.key.read() == key ? succ : nullptr;
+    }
+    /** Draw the height of a new node, geometrically distributed with ratio 1/2.
+     * @param engine Random engine
+     * @return Node height, in [1, nblevels]
+    **/
+    template<class Engine> size_t height(Engine& engine) const {
+        size_t res = 1;
+        while (res < nblevels && (engine() & 1))
+            ++res;
+        return res;
+    }
+public:
+    /** Skip list workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbkeys      Number of distinct keys, half of them initially in the set
+     * @param nblevels    Number of levels in [1, max_levels], 1 for a sorted linked list
+     * @param prob_update Probability of running an insertion or deletion (evenly), instead of a lookup
+     * @param keys        Distribution of the accessed keys
+     * @param mode        Node allocation mode
+    **/
+    WorkloadSkipList(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, size_t nblevels, float prob_update, KeyDistribution keys, NodePool::Mode mode): Workload{library, alignof(Key), Node::size(nblevels) + NodePool::size(mode, nbworkers, Node::size(nblevels), nbkeys)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbkeys{nbkeys}, nblevels{nblevels}, prob_update{prob_update}, keys{keys}, pool{mode, nbworkers, Node::size(nblevels), nbkeys, Node::size(nblevels)}, deltas{new ptrdiff_t[nbworkers]()} {}
+private:
+    /** Read-only lookup transaction.
+     * @param key Key to look up
+     * @return Whether no inconsistency has been found
+    **/
+    bool contains_tx(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            bool sane;
+            search(tx, key, nullptr, sane);
+            return sane;
+        });
+    }
+    /** Read-write insertion transaction.
+     * @param uid    Id of the thread running the transaction
+     * @param key    Key to insert
+     * @param height Height of the node to insert
+     * @return Whether the key was inserted (i.e. not already present)
+    **/
+    bool insert_tx(Uid uid, Key key, size_t height) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            void* preds[max_levels];
+            bool sane;
+            if (search(tx, key, preds, sane) || unlikely(!sane))
+                return false;
+            auto address = pool.alloc(tx, uid);
+            Node node{tx, address};
+            node.key = key;
+            for (size_t level = 0; level < height; ++level) {
+                Node pred{tx, preds[level]};
+                node.next[level] = pred.next[level].read();
+                pred.next[level] = reinterpret_cast<Node*>(address);
+            }
+            return true;
+        });
+    }
+    /** Read-write deletion transaction.
+     * @param uid Id of the thread running the transaction
+     * @param key Key to delete
+     * @return Whether the key was deleted (i.e. present)
+    **/
+    bool delete_tx(Uid uid, Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            void* preds[max_levels];
+            bool sane;
+            auto address = search(tx, key, preds, sane);
+            if (!address)
+                return false;
+            Node node{tx, address};
+            for (size_t level = 0; level < nblevels; ++level) {
+                Node pred{tx, preds[level]};
+                if (pred.next[level].read() != address) // Node not that high
+                    break;
+                pred.next[level] = node.next[level].read();
+            }
+            pool.free(tx, uid, address);
+            return true;
+        });
+    }
+public:
+    /**
+     * Initialize the set with the even keys, in one transaction run by the first worker only.
+    **/
+    virtual char const* init() const {
+        if (initialized.test_and_set(::std::memory_order_relaxed))
+            return nullptr;
+        ::std::minstd_rand engine{static_cast<Seed>(nbkeys)};
+        ::std::vector<size_t> heights;
+        for (Key key = 0; key < nbkeys; key += 2)
+            heights.push_back(height(engine));
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            pool.init(tx);
+            void* lasts[max_levels]; // Last node at each level, built in increasing key order
+            for (size_t level = 0; level < nblevels; ++level) {
+                lasts[level] = tm.get_start();
+                Node{tx, lasts[level]}.next[level] = nullptr;
+            }
+            for (Key key = 0; key < nbkeys; key += 2) {
+                auto address = pool.alloc(tx, 0);
+                Node node{tx, address};
+                node.key = key;
+                for (size_t level = 0; level < heights[key / 2]; ++level) {
+                    node.next[level] = nullptr;
+                    Node{tx, lasts[level]}.next[level] = reinterpret_cast<Node*>(address);
+                    lasts[level] = address;
+                }
+            }
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Node* first = Node{tx, tm.get_start()}.next[0];
+            return nbkeys == 0 || (first && Node{tx, first}.key.read() == 0);
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk random lookups, insertions and deletions.
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution insert_dist{0.5};
+        auto key = keys; // Private copy, as it caches per-count constants
+        ptrdiff_t delta = 0;
+        auto pacer = arrivals(uid, seed);
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            pacer.arrive();
+            Key k = key(engine, nbkeys);
+            if (!update_dist(engine)) {
+                if (unlikely(!contains_tx(k)))
+                    return "Violated isolation or atomicity";
+            } else if (insert_dist(engine)) {
+                if (insert_tx(uid, k, height(engine)))
+                    ++delta;
+            } else {
+                if (delete_tx(uid, k))
+                    --delta;
+            }
+            pacer.depart();
+        }
+        deltas[uid] += delta;
+        return nullptr;
+    }
+    /**
+     * Check the ordering of every level, their nesting, the element count and the node pool in one read-only transaction.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            ::std::vector<void*> below; // Nodes of the level below, in order
+            for (size_t level = 0; level < nblevels; ++level) {
+                ::std::vector<void*> nodes;
+                size_t index = 0; // Position in the level below
+                Key last = 0;
+                for (void* cur = Node{tx, tm.get_start()}.next[level]; cur; cur = Node{tx, cur}.next[level].read()) {
+                    if (unlikely(!pool.owns(tx, cur) || nodes.size() >= nbkeys))
+                        return "Violated consistency (dangling or cyclic link in the skip list)";
+                    Key key = Node{tx, cur}.key;
+                    if (unlikely(key >= nbkeys || (!nodes.empty() && key <= last)))
+                        return "Violated isolation or atomicity (unknown or unordered key in the skip list)";
+                    if (level > 0) { // Must also be linked in the level below
+                        while (index < below.size() && below[index] != cur)
+                            ++index;
+                        if (unlikely(index == below.size()))
+                            return "Violated isolation or atomicity (node missing from a lower level of the skip list)";
+                    }
+                    nodes.push_back(cur);
+                    last = key;
+                }
+                if (level == 0) {
+                    auto expected = static_cast<ptrdiff_t>((nbkeys + 1) / 2);
+                    for (size_t i = 0; i < nbworkers; ++i)
+                        expected += deltas[i];
+                    if (unlikely(static_cast<ptrdiff_t>(nodes.size()) != expected))
+                        return "Violated atomicity (number of keys in the skip list not matching the committed insertions and deletions)";
+                    if (pool.get_nbnodes() > 0) { // Every preallocated node must be either linked or free, not both
+                        auto free = pool.free_nodes(tx);
+                        free.insert(free.end(), nodes.begin(), nodes.end());
+                        ::std::sort(free.begin(), free.end());
+                        if (unlikely(free.size() != pool.get_nbnodes() || ::std::adjacent_find(free.begin(), free.end()) != free.end()))
+                            return "Violated isolation or atomicity (leaked or doubly-used node in the skip list pool)";
+                    }
+                }
+                below.swap(nodes);
+            }
+            return nullptr;
+        });
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** FIFO queue workload class, a bounded ring in the first segment shared by producer and consumer workers.
+**/
+class WorkloadQueue final: public Workload {
+public:
+    /** Item class alias, the sequence number of an item among the ones produced in a run.
+    **/
+    using Item = uintptr_t;
+    constexpr static uint64_t max_idle_polls = uint64_t{1} << 24; // Consecutive idle polls after which a worker gives up, the other side having stalled
+private:
+    /** Shared ring class.
+    **/
+    class Ring final {
+    public:
+        /** Get the ring size for a given capacity.
+         * @param capacity Number of slots
+         * @return Ring size (in bytes)
+        **/
+        constexpr static auto size(size_t capacity) noexcept {
+            return 2 * sizeof(size_t) + capacity * sizeof(Item);
+        }
+    public:
+        Shared<size_t> head;  // Number of dequeued items since initialization
+        Shared<size_t> tail;  // Number of enqueued items since initialization
+        Shared<Item[]> slots; // Circular buffer of items
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Ring(Ring const&) = delete;
+        Ring& operator=(Ring const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Ring base address
+        **/
+        Ring(Transaction& tx, void* address): head{tx, address}, tail{tx, head.after()}, slots{tx, tail.after()} {}
+    };
+private:
+    size_t nbworkers;   // Number of concurrent workers, the first ones producing and the other ones consuming
+    size_t nbproducers; // Number of producer workers
+    size_t nbitems;     // Number of items produced (and consumed) per run
+    size_t capacity;    // Number of slots in the ring
+    ::std::unique_ptr<::std::vector<Item>[]> received; // Per-worker items dequeued during the last run, in order
+    ::std::atomic_flag mutable initialized = ATOMIC_FLAG_INIT; // Whether a worker already took care of the initialization
+    ::std::atomic<bool> mutable failed{false}; // Whether a worker failed its run, the others then giving up instead of polling forever
+private:
+    /** Record the failure of a worker's run, so that the workers polling the ring give up.
+     * @param error Constant null-terminated error message
+     * @return Error message
+    **/
+    char const* fail(char const* error) const noexcept {
+        failed.store(true, ::std::memory_order_relaxed);
+        return error;
+    }
+    /** Account for an idle poll of the ring, telling whether to give up.
+     * @param polls Number of consecutive idle polls so far, incremented
+     * @param error Error message to end the run with if giving up, 'nullptr' if another worker failed and reports its own (output)
+     * @return Whether to poll again
+    **/
+    bool idle(uint64_t& polls, char const*& error) const noexcept {
+        ++transaction_counters.idle;
+        if (unlikely(failed.load(::std::memory_order_relaxed))) {
+            error = nullptr;
+            return false;
+        }
+        if (unlikely(++polls >= max_idle_polls)) {
+            error = fail("No progress of the other side of the ring (full or empty for too long)");
+            return false;
+        }
+        short_pause();
+        return true;
+    }
+    /** Read-write enqueue transaction.
+     * @param item Item to enqueue
+     * @return Whether the item was enqueued (i.e. the ring was not full)
+    **/
+    bool enqueue_tx(Item item) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            size_t tail = ring.tail;
+            if (tail - ring.head.read() >= capacity)
+                return false;
+            ring.slots.write(tail % capacity, item);
+            ring.tail = tail + 1;
+            return true;
+        });
+    }
+    /** Read-write dequeue transaction.
+     * @param item Dequeued item (output)
+     * @return Whether an item was dequeued (i.e. the ring was not empty)
+    **/
+    bool dequeue_tx(Item& item) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            size_t head = ring.head;
+            if (head == ring.tail.read())
+                return false;
+            item = ring.slots.read(head % capacity);
+            ring.head = head + 1;
+            return true;
+        });
+    }
+    /** Get the number of items a worker produces or consumes in a run.
+     * @param uid Worker unique ID
+     * @return Number of items
+    **/
+    size_t share(Uid uid) const noexcept {
+        auto const producer = uid < nbproducers;
+        auto const count = producer ? nbproducers : nbworkers - nbproducers;
+        auto const rank  = producer ? uid : uid - nbproducers;
+        return nbitems / count + (rank < nbitems % count ? 1 : 0);
+    }
+public:
+    /** Queue workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check'), at least 2
+     * @param nbtxperwrk  Number of successful transactions per worker, on average
+     * @param nbproducers Number of producer workers, in [1, nbworkers - 1]
+     * @param capacity    Number of slots in the ring
+    **/
+    WorkloadQueue(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbproducers, size_t capacity): Workload{library, alignof(size_t), Ring::size(capacity)}, nbworkers{nbworkers}, nbproducers{nbproducers}, nbitems{nbworkers * nbtxperwrk / 2}, capacity{capacity}, received{new ::std::vector<Item>[nbworkers]} {}
+public:
+    /**
+     * Initialize an empty ring, in one transaction run by the first worker only.
+    **/
+    virtual char const* init() const {
+        if (initialized.test_and_set(::std::memory_order_relaxed))
+            return nullptr;
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            ring.head = 0;
+            ring.tail = 0;
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            return ring.head.read() == 0 && ring.tail.read() == 0;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Enqueue (producers) or dequeue (consumers) the worker's share of the run's items, retrying while the ring is full or empty,
+     * up to 'max_idle_polls' consecutive times or until another worker failed.
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        auto const count = share(uid);
+        if (uid < nbproducers) { // Producer 'uid' enqueues items uid, uid + nbproducers, ... (only producers are paced in open-loop runs)
+            auto pacer = arrivals(uid, seed);
+            for (size_t i = 0; i < count; ++i) {
+                pacer.arrive();
+                uint64_t polls = 0;
+                char const* error;
+                while (!enqueue_tx(uid + i * nbproducers)) {
+                    if (unlikely(!idle(polls, error)))
+                        return error;
+                }
+                pacer.depart();
+            }
+            return nullptr;
+        }
+        auto& items = received[uid];
+        items.clear();
+        items.reserve(count);
+        ::std::vector<Item> last(nbproducers, ~Item{0}); // Last item seen from each producer
+        for (size_t i = 0; i < count; ++i) {
+            Item item;
+            uint64_t polls = 0;
+            char const* error;
+            while (!dequeue_tx(item)) {
+                if (unlikely(!idle(polls, error)))
+                    return error;
+            }
+            if (unlikely(item >= nbitems))
+                return fail("Violated isolation or atomicity (unknown item dequeued)");
+            auto& prev = last[item % nbproducers];
+            if (unlikely(prev != ~Item{0} && item <= prev)) // Items of a producer must come out in order
+                return fail("Violated isolation (items of a producer dequeued out of order)");
+            prev = item;
+            items.push_back(item);
+        }
+        return nullptr;
+    }
+    /**
+     * Check that every item of the last run has been dequeued exactly once and that the ring is empty.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        auto empty = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            return ring.head.read() == ring.tail.read();
+        });
+        if (unlikely(!empty))
+            return "Violated atomicity (items left in the queue)";
+        ::std::vector<bool> seen(nbitems, false);
+        size_t count = 0;
+        for (size_t i = nbproducers; i < nbworkers; ++i) {
+            for (auto item: received[i]) {
+                if (unlikely(seen[item]))
+                    return "Violated isolation or atomicity (item dequeued twice)";
+                seen[item] = true;
+                ++count;
+            }
+        }
+        if (unlikely(count != nbitems))
+            return "Violated atomicity (item lost in the queue)";
+        return nullptr;
+    }
+    /** Tell that the runs cannot be serialized, producers waiting for consumers to drain the ring and vice versa.
+     * @return False
+    **/
+    virtual bool can_run_serially() const noexcept {
+        return false;
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Red-black tree workload class, a sorted set of keys whose nodes come from a node pool.
+**/
+class WorkloadRBTree final: public Workload {
+public:
+    /** Key and color class aliases.
+    **/
+    using Key   = uintptr_t;
+    using Color = uintptr_t;
+    constexpr static Color red   = 0;
+    constexpr static Color black = 1;
+private:
+    /** Shared node class.
+    **/
+    class Node final {
+    public:
+        /** Get the node size.
+         * @return Node size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Key) + sizeof(Color) + 3 * sizeof(Node*);
+        }
+    public:
+        Shared<Key>   key;    // Key
+        Shared<Color> color;  // Color, 'red' or 'black'
+        Shared<Node*> left;   // Left child
+        Shared<Node*> right;  // Right child
+        Shared<Node*> parent; // Parent, 'nullptr' for the root
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Node(Node const&) = delete;
+        Node& operator=(Node const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Node base address
+        **/
+        Node(Transaction& tx, void* address): key{tx, address}, color{tx, key.after()}, left{tx, color.after()}, right{tx, left.after()}, parent{tx, right.after()} {}
+    };
+    /** Tree operations class, bound to a pending transaction (null children are black leaves).
+    **/
+    class Tree final {
+    private:
+        Transaction&    tx;   // Bound transaction
+        NodePool const& pool; // Node pool
+        Uid             uid;  // Id of the thread running the transaction
+        Shared<Node*>   root; // Root pointer, at the start of the first segment
+    public:
+        /** Binding constructor.
+         * @param tx   Transaction to bind
+         * @param pool Node pool
+         * @param uid  Id of the thread running the transaction
+        **/
+        Tree(Transaction& tx, NodePool const& pool, Uid uid): tx{tx}, pool{pool}, uid{uid}, root{tx, tx.get_tm().get_start()} {}
+    private:
+        /** Read a field of a node.
+         * @param node Node to read, possibly 'nullptr' (except for the key) as a black leaf
+         * @return Field value, 'nullptr' or 'black' for a leaf
+        **/
+        Key key(Node* node) const {
+            return Node{tx, node}.key;
+        }
+        Node* left(Node* node) const {
+            return node ? Node{tx, node}.left.read() : nullptr;
+        }
+        Node* right(Node* node) const {
+            return node ? Node{tx, node}.right.read() : nullptr;
+        }
+        Node* parent(Node* node) const {
+            return node ? Node{tx, node}.parent.read() : nullptr;
+        }
+        Color color(Node* node) const {
+            return node ? Node{tx, node}.color.read() : black;
+        }
+        /** Write a field of a node.
+         * @param node  Node to write, possibly 'nullptr' for the color (ignored)
+         * @param value Field value
+        **/
+        void set_left(Node* node, Node* value) const {
+            Node{tx, node}.left = value;
+        }
+        void set_right(Node* node, Node* value) const {
+            Node{tx, node}.right = value;
+        }
+        void set_parent(Node* node, Node* value) const {
+            Node{tx, node}.parent = value;
+        }
+        void set_color(Node* node, Color value) const {
+            if (node)
+                Node{tx, node}.color = value;
+        }
+        /** Replace a child link of a node's parent (or the root).
+         * @param node  Current child
+         * @param child New child
+        **/
+        void replace(Node* node, Node* child) const {
+            auto p = parent(node);
+            if (!p) {
+                root = child;
+            } else if (left(p) == node) {
+                set_left(p, child);
+            } else {
+                set_right(p, child);
+            }
+        }
+        /** Left rotation around a node.
+         * @param node Node whose right child moves up
+        **/
+        void rotate_left(Node* node) const {
+            auto r  = right(node);
+            auto rl = left(r);
+            set_right(node, rl);
+            if (rl)
+                set_parent(rl, node);
+            set_parent(r, parent(node));
+            replace(node, r);
+            set_left(r, node);
+            set_parent(node, r);
+        }
+        /** Right rotation around a node.
+         * @param node Node whose left child moves up
+        **/
+        void rotate_right(Node* node) const {
+            auto l  = left(node);
+            auto lr = right(l);
+            set_left(node, lr);
+            if (lr)
+                set_parent(lr, node);
+            set_parent(l, parent(node));
+            replace(node, l);
+            set_right(l, node);
+            set_parent(node, l);
+        }
+        /** Restore the invariants after inserting a red node.
+         * @param node Inserted node
+        **/
+        void fix_insert(Node* node) const {
+            while (node != root.read() && color(parent(node)) == red) {
+                auto p = parent(node);
+                auto g = parent(p);
+                if (p == left(g)) {
+                    auto uncle = right(g);
+                    if (color(uncle) == red) {
+                        set_color(p, black);
+                        set_color(uncle, black);
+                        set_color(g, red);
+                        node = g;
+                    } else {
+                        if (node == right(p)) {
+                            node = p;
+                            rotate_left(node);
+                            p = parent(node);
+                        }
+                        set_color(p, black);
+                        set_color(g, red);
+                        rotate_right(g);
+                    }
+                } else {
+                    auto uncle = left(g);
+                    if (color(uncle) == red) {
+                        set_color(p, black);
+                        set_color(uncle, black);
+                        set_color(g, red);
+                        node = g;
+                    } else {
+                        if (node == left(p)) {
+                            node = p;
+                            rotate_right(node);
+                            p = parent(node);
+                        }
+                        set_color(p, black);
+                        set_color(g, red);
+                        rotate_left(g);
+                    }
+                }
+            }
+            set_color(root, black);
+        }
+        /** Restore the invariants after removing a black node.
+         * @param node Node taking the place of the removed one (possibly the removed leaf itself, not unlinked yet)
+        **/
+        void fix_delete(Node* node) const {
+            while (node != root.read() && color(node) == black) {
+                auto p = parent(node);
+                if (node == left(p)) {
+                    auto sibling = right(p);
+                    if (color(sibling) == red) {
+                        set_color(sibling, black);
+                        set_color(p, red);
+                        rotate_left(p);
+                        sibling = right(p);
+                    }
+                    if (color(left(sibling)) == black && color(right(sibling)) == black) {
+                        set_color(sibling, red);
+                        node = p;
+                    } else {
+                        if (color(right(sibling)) == black) {
+                            set_color(left(sibling), black);
+                            set_color(sibling, red);
+                            rotate_right(sibling);
+                            sibling = right(p);
+                        }
+                        set_color(sibling, color(p));
+                        set_color(p, black);
+                        set_color(right(sibling), black);
+                        rotate_left(p);
+                        node = root;
+                    }
+                } else {
+                    auto sibling = left(p);
+                    if (color(sibling) == red) {
+                        set_color(sibling, black);
+                        set_color(p, red);
+                        rotate_right(p);
+                        sibling = left(p);
+                    }
+                    if (color(right(sibling)) == black && color(left(sibling)) == black) {
+                        set_color(sibling, red);
+                        node = p;
+                    } else {
+                        if (color(left(sibling)) == black) {
+                            set_color(right(sibling), black);
+                            set_color(sibling, red);
+                            rotate_left(sibling);
+                            sibling = left(p);
+                        }
+                        set_color(sibling, color(p));
+                        set_color(p, black);
+                        set_color(left(sibling), black);
+                        rotate_right(p);
+                        node = root;
+                    }
+                }
+            }
+            set_color(node, black);
+        }
+    public:
+        /** Look up a key.
+         * @param key      Key to look up
+         * @param maxdepth Maximum expected depth
+         * @param sane     Set to whether the descent was shorter than the maximum depth (output)
+         * @return Node holding the key, 'nullptr' if absent
+        **/
+        Node* find(Key key, size_t maxdepth, bool& sane) const {
+            sane = true;
+            Node* cur = root;
+            for (size_t depth = 0; cur; ++depth) {
+                if (unlikely(depth > maxdepth)) {
+                    sane = false;
+                    return nullptr;
+                }
+                auto k = this->key(cur);
+                if (key == k)
+                    return cur;
+                cur = key < k ? left(cur) : right(cur);
+            }
+            return nullptr;
+        }
+        /** Insert a key.
+         * @param key Key to insert
+         * @return Whether the key was inserted (i.e. not already present)
+        **/
+        bool insert(Key key) const {
+            Node* p = nullptr;
+            Node* cur = root;
+            while (cur) {
+                auto k = this->key(cur);
+                if (key == k)
+                    return false;
+                p   = cur;
+                cur = key < k ? left(cur) : right(cur);
+            }
+            auto node = reinterpret_cast<Node*>(pool.alloc(tx, uid));
+            Node shared{tx, node};
+            shared.key    = key;
+            shared.color  = red;
+            shared.left   = nullptr;
+            shared.right  = nullptr;
+            shared.parent = p;
+            if (!p) {
+                root = node;
+            } else if (key < this->key(p)) {
+                set_left(p, node);
+            } else {
+                set_right(p, node);
+            }
+            fix_insert(node);
+            return true;
+        }
+        /** Remove the node holding a key.
+         * @param node Node to remove
+        **/
+        void erase(Node* node) const {
+            if (left(node) && right(node)) { // Move the successor's key here, then remove the successor instead
+                auto succ = right(node);
+                for (auto next = left(succ); next; next = left(succ))
+                    succ = next;
+                Node{tx, node}.key = key(succ);
+                node = succ;
+            }
+            auto child = left(node) ? left(node) : right(node);
+            if (child) {
+                set_parent(child, parent(node));
+                replace(node, child);
+                if (color(node) == black)
+                    fix_delete(child);
+            } else if (!parent(node)) {
+                root = nullptr;
+            } else {
+                if (color(node) == black) // Fix up using the removed leaf as a phantom, before unlinking it
+                    fix_delete(node);
+                replace(node, nullptr);
+            }
+            pool.free(tx, uid, node);
+        }
+    };
+private:
+    size_t          nbworkers;   // Number of concurrent workers
+    size_t          nbtxperwrk;  // Number of transactions per worker
+    size_t          nbkeys;      // Number of distinct keys, half of them initially in the tree
+    float           prob_update; // Probability of running an insertion or deletion (evenly), instead of a lookup
+    KeyDistribution keys;        // Distribution of the accessed keys
+    NodePool        pool;        // Node pool, right after the root pointer in the first segment
+    ::std::unique_ptr<ptrdiff_t[]> deltas; // Per-worker net number of inserted keys since initialization
+    ::std::atomic_flag mutable initialized = ATOMIC_FLAG_INIT; // Whether a worker already took care of the initialization
+private:
+    /** Recursively check the subtree of a node.
+     * @param tx     Associated pending transaction
+     * @param node   Subtree root, possibly 'nullptr'
+     * @param parent Expected parent
+     * @param low    Exclusive lower key bound (ignored if 'nullptr')
+     * @param high   Exclusive upper key bound (ignored if 'nullptr')
+     * @param nodes  Visited nodes (output)
+     * @param error  Set to the error message on failure (output)
+     * @return Black height of the subtree (counting the leaves), 0 on failure
+    **/
+    size_t check_subtree(Transaction& tx, Node* node, Node* parent, Key const* low, Key const* high, ::std::vector<void*>& nodes, char const*& error) const {
+        if (!node)
+            return 1;
+        if (unlikely(!pool.owns(tx, node) || nodes.size() >= nbkeys)) {
+            error = "Violated consistency (dangling or cyclic link in the red-black tree)";
+            return 0;
+        }
+        nodes.push_back(node);
+        Node shared{tx, node};
+        Key key = shared.key;
+        Color color = shared.color;
+        if (unlikely(shared.parent.read() != parent)) {
+            error = "Violated isolation or atomicity (wrong parent link in the red-black tree)";
+            return 0;
+        }
+        if (unlikely(key >= nbkeys || (low && key <= *low) || (high && key >= *high))) {
+            error = "Violated isolation or atomicity (unknown or unordered key in the red-black tree)";
+            return 0;
+        }
+        if (unlikely(color != red && color != black)) {
+            error = "Violated isolation or atomicity (invalid color in the red-black tree)";
+            return 0;
+        }
+        Node* left  = shared.left;
+        Node* right = shared.right;
+        if (unlikely(color == red && ((left && Node(tx, left).color.read() == red) || (right && Node(tx, right).color.read() == red)))) {
+            error = "Violated isolation or atomicity (red node with a red child in the red-black tree)";
+            return 0;
+        }
+        auto lh = check_subtree(tx, left, node, low, &key, nodes, error);
+        if (lh == 0)
+            return 0;
+        auto rh = check_subtree(tx, right, node, &key, high, nodes, error);
+        if (rh == 0)
+            return 0;
+        if (unlikely(lh != rh)) {
+            error = "Violated isolation or atomicity (unbalanced black height in the red-black tree)";
+            return 0;
+        }
+        return lh + (color == black ? 1 : 0);
+    }
+public:
+    /** Red-black tree workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbkeys      Number of distinct keys, half of them initially in the tree
+     * @param prob_update Probability of running an insertion or deletion (evenly), instead of a lookup
+     * @param keys        Distribution of the accessed keys
+     * @param mode        Node allocation mode
+    **/
+    WorkloadRBTree(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, float prob_update, KeyDistribution keys, NodePool::Mode mode): Workload{library, alignof(Key), sizeof(Node*) + NodePool::size(mode, nbworkers, Node::size(), nbkeys)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbkeys{nbkeys}, prob_update{prob_update}, keys{keys}, pool{mode, nbworkers, Node::size(), nbkeys, sizeof(Node*)}, deltas{new ptrdiff_t[nbworkers]()} {}
+private:
+    /** Read-only lookup transaction.
+     * @param key Key to look up
+     * @return Whether no inconsistency has been found
+    **/
+    bool lookup_tx(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            bool sane;
+            Tree{tx, pool, 0}.find(key, 2 * nbkeys, sane);
+            return sane;
+        });
+    }
+    /** Read-write insertion transaction.
+     * @param uid Id of the thread running the transaction
+     * @param key Key to insert
+     * @return Whether the key was inserted (i.e. not already present)
+    **/
+    bool insert_tx(Uid uid, Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            return Tree{tx, pool, uid}.insert(key);
+        });
+    }
+    /** Read-write deletion transaction.
+     * @param uid Id of the thread running the transaction
+     * @param key Key to delete
+     * @return Whether the key was deleted (i.e. present)
+    **/
+    bool delete_tx(Uid uid, Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Tree tree{tx, pool, uid};
+            bool sane;
+            auto node = tree.find(key, 2 * nbkeys, sane);
+            if (!node)
+                return false;
+            tree.erase(node);
+            return true;
+        });
+    }
+public:
+    /**
+     * Initialize the tree with the even keys, in one transaction run by the first worker only.
+    **/
+    virtual char const* init() const {
+        if (initialized.test_and_set(::std::memory_order_relaxed))
+            return nullptr;
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            pool.init(tx);
+            Shared<Node*>{tx, tm.get_start()} = nullptr;
+            Tree tree{tx, pool, 0};
+            for (Key key = 0; key < nbkeys; key += 2)
+                tree.insert(key);
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            bool sane;
+            return nbkeys == 0 || Tree{tx, pool, 0}.find(0, 2 * nbkeys, sane) != nullptr;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk random lookups, insertions and deletions.
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution insert_dist{0.5};
+        auto key = keys; // Private copy, as it caches per-count constants
+        ptrdiff_t delta = 0;
+        auto pacer = arrivals(uid, seed);
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            pacer.arrive();
+            Key k = key(engine, nbkeys);
+            if (!update_dist(engine)) {
+                if (unlikely(!lookup_tx(k)))
+                    return "Violated isolation or atomicity";
+            } else if (insert_dist(engine)) {
+                if (insert_tx(uid, k))
+                    ++delta;
+            } else {
+                if (delete_tx(uid, k))
+                    --delta;
+            }
+            pacer.depart();
+        }
+        deltas[uid] += delta;
+        return nullptr;
+    }
+    /**
+     * Check the search tree ordering, parent links, red-black invariants, element count and node pool in one read-only transaction.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            ::std::vector<void*> nodes;
+            char const* error = nullptr;
+            Node* root = Shared<Node*>{tx, tm.get_start()};
+            if (unlikely(root && Node(tx, root).color.read() != black))
+                return "Violated isolation or atomicity (red root in the red-black tree)";
+            if (check_subtree(tx, root, nullptr, nullptr, nullptr, nodes, error) == 0)
+                return error;
+            auto expected = static_cast<ptrdiff_t>((nbkeys + 1) / 2);
+            for (size_t i = 0; i < nbworkers; ++i)
+                expected += deltas[i];
+            if (unlikely(static_cast<ptrdiff_t>(nodes.size()) != expected))
+                return "Violated atomicity (number of keys in the red-black tree not matching the committed insertions and deletions)";
+            if (pool.get_nbnodes() > 0) { // Every preallocated node must be either linked or free, not both
+                auto free = pool.free_nodes(tx);
+                free.insert(free.end(), nodes.begin(), nodes.end());
+                ::std::sort(free.begin(), free.end());
+                if (unlikely(free.size() != pool.get_nbnodes() || ::std::adjacent_find(free.begin(), free.end()) != free.end()))
+                    return "Violated isolation or atomicity (leaked or doubly-used node in the red-black tree pool)";
+            }
+            return nullptr;
+        });
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Travel reservation workload class, a port of STAMP's "vacation" benchmark.
+ * Cars, flights and rooms tables map a relation ID to a resource, the customers table maps a customer ID to its reservation list.
+ * The tables are indexed by ID in the first segment (an absent resource has no units), and reservation records come from a node pool.
+**/
+class WorkloadVacation final: public Workload {
+public:
+    /** Resource type enum, and amount/price class alias.
+    **/
+    enum Type: size_t {
+        car,
+        flight,
+        room,
+        nbtypes
+    };
+    using Amount = intptr_t;
+private:
+    /** Shared resource class.
+    **/
+    class Resource final {
+    public:
+        /** Get the resource size.
+         * @return Resource size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return 3 * sizeof(Amount);
+        }
+    public:
+        Shared<Amount> total; // Total number of units, 0 if the resource does not exist
+        Shared<Amount> free;  // Number of units not reserved
+        Shared<Amount> price; // Price of one unit
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Resource(Resource const&) = delete;
+        Resource& operator=(Resource const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Resource base address
+        **/
+        Resource(Transaction& tx, void* address): total{tx, address}, free{tx, total.after()}, price{tx, free.after()} {}
+    };
+    /** Shared reservation record class, in a customer's list sorted by reserved resource.
+    **/
+    class Reservation final {
+    public:
+        /** Get the record size.
+         * @return Record size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return 2 * sizeof(Amount) + sizeof(Reservation*);
+        }
+    public:
+        Shared<Amount>       what;  // Reserved resource, as 'type * nbrelations + id'
+        Shared<Amount>       price; // Price at reservation time
+        Shared<Reservation*> next;  // Next record
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Reservation(Reservation const&) = delete;
+        Reservation& operator=(Reservation const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Record base address
+        **/
+        Reservation(Transaction& tx, void* address): what{tx, address}, price{tx, what.after()}, next{tx, price.after()} {}
+    };
+    /** Shared customer class.
+    **/
+    class Customer final {
+    public:
+        /** Get the customer size.
+         * @return Customer size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Amount) + sizeof(Reservation*);
+        }
+    public:
+        Shared<Amount>       exists;       // Whether the customer exists
+        Shared<Reservation*> reservations; // Reservation list, by increasing reserved resource
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Customer(Customer const&) = delete;
+        Customer& operator=(Customer const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Customer base address
+        **/
+        Customer(Transaction& tx, void* address): exists{tx, address}, reservations{tx, exists.after()} {}
+    };
+    /** Query class, one resource looked up or updated by a transaction.
+    **/
+    struct Query {
+        Type   type;  // Resource type
+        size_t id;    // Relation ID
+        bool   add;   // Whether to add units (or remove them), for table updates
+        Amount price; // New unit price, for table updates adding units
+    };
+private:
+    size_t   nbworkers;    // Number of concurrent workers
+    size_t   nbtxperwrk;   // Number of transactions per worker
+    size_t   nbrelations;  // Number of relations (resources of each type, and customers)
+    size_t   nbqueries;    // Maximum number of queries per transaction
+    size_t   query_range;  // Number of relations the queries are drawn from
+    unsigned percent_user; // Percentage of reservation transactions, the others evenly deleting customers or updating the tables
+    NodePool pool;         // Reservation record pool, after the tables in the first segment
+    ::std::atomic_flag mutable initialized = ATOMIC_FLAG_INIT; // Whether a worker already took care of the initialization
+private:
+    /** Get the address of a resource.
+     * @param type Resource type
+     * @param id   Relation ID
+     * @return Resource address
+    **/
+    void* resource(Type type, size_t id) const noexcept {
+        return reinterpret_cast<char*>(tm.get_start()) + (type * nbrelations + id) * Resource::size();
+    }
+    /** Get the address of a customer.
+     * @param id Customer ID
+     * @return Customer address
+    **/
+    void* customer(size_t id) const noexcept {
+        return reinterpret_cast<char*>(tm.get_start()) + nbtypes * nbrelations * Resource::size() + id * Customer::size();
+    }
+    /** Reserve one unit of a resource for a customer, at most once per customer and resource.
+     * @param tx   Associated pending transaction
+     * @param uid  Id of the thread running the transaction
+     * @param cid  Customer ID
+     * @param type Resource type
+     * @param id   Relation ID
+     * @return Whether the reservation was made
+    **/
+    bool reserve(Transaction& tx, Uid uid, size_t cid, Type type, size_t id) const {
+        Customer cust{tx, customer(cid)};
+        if (!cust.exists.read())
+            return false;
+        Resource res{tx, resource(type, id)};
+        if (res.total.read() == 0)
+            return false;
+        Amount free = res.free;
+        if (free == 0)
+            return false;
+        auto const what = static_cast<Amount>(type * nbrelations + id);
+        void* link = cust.reservations.get(); // Link to the record to insert before
+        Reservation* cur = cust.reservations;
+        while (cur) {
+            Reservation record{tx, cur};
+            Amount found = record.what;
+            if (found == what) // Already reserved
+                return false;
+            if (found > what)
+                break;
+            link = record.next.get();
+            cur  = record.next;
+        }
+        auto address = pool.try_alloc(tx, uid);
+        if (!address) // Out of records
+            return false;
+        Reservation record{tx, address};
+        record.what  = what;
+        record.price = res.price.read();
+        record.next  = cur;
+        Shared<Reservation*>{tx, link} = reinterpret_cast<Reservation*>(address);
+        res.free = free - 1;
+        return true;
+    }
+    /** Add units to a resource, creating it if needed.
+     * @param tx    Associated pending transaction
+     * @param type  Resource type
+     * @param id    Relation ID
+     * @param count Number of units to add
+     * @param price New unit price
+    **/
+    void add(Transaction& tx, Type type, size_t id, Amount count, Amount price) const {
+        Resource res{tx, resource(type, id)};
+        res.total = res.total.read() + count;
+        res.free  = res.free.read() + count;
+        res.price = price;
+    }
+    /** Remove units from a resource, flights being deleted whole and only if no unit is reserved.
+     * @param tx    Associated pending transaction
+     * @param type  Resource type
+     * @param id    Relation ID
+     * @param count Number of units to remove (cars and rooms)
+     * @return Whether the units were removed
+    **/
+    bool remove(Transaction& tx, Type type, size_t id, Amount count) const {
+        Resource res{tx, resource(type, id)};
+        Amount total = res.total;
+        if (total == 0)
+            return false;
+        Amount free = res.free;
+        if (type == flight) {
+            if (free != total) // Some seats reserved
+                return false;
+            count = total;
+        } else if (free < count) {
+            return false;
+        }
+        res.total = total - count;
+        res.free  = free - count;
+        return true;
+    }
+    /** Draw a query.
+     * @param engine Random engine
+     * @return Query (for table updates, the unit price is only meaningful when adding units)
+    **/
+    template<class Engine> Query draw(Engine& engine) const {
+        Query res;
+        res.type  = static_cast<Type>(engine() % nbtypes);
+        res.id    = engine() % query_range;
+        res.add   = engine() % 2 == 0;
+        res.price = static_cast<Amount>(engine() % 5) * 10 + 50;
+        return res;
+    }
+public:
+    /** Travel reservation workload constructor.
+     * @param library      Transactional library to use
+     * @param nbworkers    Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk   Number of transactions per worker
+     * @param nbrelations  Number of relations (resources of each type, and customers)
+     * @param nbqueries    Maximum number of queries per transaction
+     * @param query_range  Number of relations the queries are drawn from, in [1, nbrelations]
+     * @param percent_user Percentage of reservation transactions, the others evenly deleting customers or updating the tables
+     * @param mode         Reservation record allocation mode
+    **/
+    WorkloadVacation(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbrelations, size_t nbqueries, size_t query_range, unsigned percent_user, NodePool::Mode mode): Workload{library, alignof(Amount), nbrelations * (nbtypes * Resource::size() + Customer::size()) + NodePool::size(mode, nbworkers, Reservation::size(), nbtypes * nbrelations)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbrelations{nbrelations}, nbqueries{nbqueries}, query_range{query_range}, percent_user{percent_user}, pool{mode, nbworkers, Reservation::size(), nbtypes * nbrelations, nbrelations * (nbtypes * Resource::size() + Customer::size())} {}
+private:
+    /** Read-write reservation transaction: look up resources, then reserve the most expensive one of each type for a customer.
+     * @param uid     Id of the thread running the transaction
+     * @param cid     Customer ID
+     * @param queries Looked up resources
+    **/
+    void reservation_tx(Uid uid, size_t cid, ::std::vector<Query> const& queries) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Amount max_prices[nbtypes] = {-1, -1, -1};
+            size_t max_ids[nbtypes];
+            for (auto&& query: queries) {
+                Resource res{tx, resource(query.type, query.id)};
+                if (res.total.read() == 0)
+                    continue;
+                Amount price = res.price;
+                if (price > max_prices[query.type]) {
+                    max_prices[query.type] = price;
+                    max_ids[query.type]    = query.id;
+                }
+            }
+            auto found = false;
+            for (size_t type = 0; type < nbtypes; ++type)
+                found = found || max_prices[type] >= 0;
+            if (!found)
+                return;
+            Customer cust{tx, customer(cid)};
+            if (!cust.exists.read())
+                cust.exists = 1;
+            for (size_t type = 0; type < nbtypes; ++type) {
+                if (max_prices[type] >= 0)
+                    reserve(tx, uid, cid, static_cast<Type>(type), max_ids[type]);
+            }
+        });
+    }
+    /** Read-write customer deletion transaction: compute the bill, then cancel every reservation.
+     * @param uid Id of the thread running the transaction
+     * @param cid Customer ID
+     * @return Bill of the deleted customer, none if the customer did not exist
+    **/
+    ::std::optional<Amount> delete_customer_tx(Uid uid, size_t cid) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) -> ::std::optional<Amount> {
+            Customer cust{tx, customer(cid)};
+            if (!cust.exists.read())
+                return ::std::nullopt;
+            Amount bill = 0;
+            for (Reservation* cur = cust.reservations; cur;) {
+                Reservation record{tx, cur};
+                Amount what = record.what;
+                bill += record.price;
+                Resource res{tx, resource(static_cast<Type>(what / nbrelations), what % nbrelations)};
+                res.free = res.free.read() + 1;
+                Reservation* next = record.next;
+                pool.free(tx, uid, cur);
+                cur = next;
+            }
+            cust.reservations = nullptr;
+            cust.exists = 0;
+            return bill;
+        });
+    }
+    /** Read-write table update transaction, adding or removing units of resources.
+     * @param queries Updated resources
+    **/
+    void update_tables_tx(::std::vector<Query> const& queries) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            for (auto&& query: queries) {
+                if (query.add) {
+                    add(tx, query.type, query.id, 100, query.price);
+                } else {
+                    remove(tx, query.type, query.id, 100);
+                }
+            }
+        });
+    }
+public:
+    /**
+     * Initialize every resource and customer, in one transaction run by the first worker only.
+    **/
+    virtual char const* init() const {
+        if (initialized.test_and_set(::std::memory_order_relaxed))
+            return nullptr;
+        ::std::minstd_rand engine{static_cast<Seed>(nbrelations)};
+        ::std::vector<Amount> amounts(2 * nbtypes * nbrelations); // Number of units and price of each resource
+        for (auto&& amount: amounts)
+            amount = static_cast<Amount>(engine() % 5);
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            pool.init(tx);
+            for (size_t type = 0; type < nbtypes; ++type) {
+                for (size_t id = 0; id < nbrelations; ++id) {
+                    auto index = 2 * (type * nbrelations + id);
+                    Resource res{tx, resource(static_cast<Type>(type), id)};
+                    res.total = (amounts[index] + 1) * 100;
+                    res.free  = (amounts[index] + 1) * 100;
+                    res.price = amounts[index + 1] * 10 + 50;
+                }
+            }
+            for (size_t id = 0; id < nbrelations; ++id) {
+                Customer cust{tx, customer(id)};
+                cust.exists = 1;
+                cust.reservations = nullptr;
+            }
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            return Customer{tx, customer(0)}.exists.read() == 1 && Resource{tx, resource(car, 0)}.total.read() >= 100;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk random client actions (reservation, customer deletion or table update).
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::vector<Query> queries;
+        auto pacer = arrivals(uid, seed);
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            pacer.arrive();
+            auto const action = engine() % 100;
+            queries.resize(engine() % nbqueries + 1);
+            for (auto&& query: queries)
+                query = draw(engine);
+            auto const cid = engine() % query_range;
+            if (action < percent_user) {
+                reservation_tx(uid, cid, queries);
+            } else if (action % 2 == 1) {
+                auto const bill = delete_customer_tx(uid, cid);
+                if (unlikely(bill && *bill < 0))
+                    return "Violated isolation or atomicity (negative bill)";
+            } else {
+                update_tables_tx(queries);
+            }
+            pacer.depart();
+        }
+        return nullptr;
+    }
+    /**
+     * Check that every resource's reserved units match the customers' reservations, and the reservation lists, in one read-only transaction.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            ::std::vector<Amount> used(nbtypes * nbrelations, 0);
+            ::std::vector<void*> records;
+            for (size_t id = 0; id < nbrelations; ++id) {
+                Customer cust{tx, customer(id)};
+                Amount exists = cust.exists;
+                Reservation* cur = cust.reservations;
+                if (unlikely((exists != 0 && exists != 1) || (!exists && cur)))
+                    return "Violated isolation or atomicity (deleted customer with reservations)";
+                Amount last = -1;
+                for (; cur; cur = Reservation{tx, cur}.next.read()) {
+                    if (unlikely(!pool.owns(tx, cur) || records.size() >= nbtypes * nbrelations))
+                        return "Violated consistency (dangling or cyclic link in a reservation list)";
+                    Amount what = Reservation{tx, cur}.what;
+                    if (unlikely(what <= last || what >= static_cast<Amount>(nbtypes * nbrelations)))
+                        return "Violated isolation or atomicity (unknown or unordered reservation)";
+                    ++used[what];
+                    last = what;
+                    records.push_back(cur);
+                }
+            }
+            for (size_t type = 0; type < nbtypes; ++type) {
+                for (size_t id = 0; id < nbrelations; ++id) {
+                    Resource res{tx, resource(static_cast<Type>(type), id)};
+                    Amount total = res.total;
+                    Amount free  = res.free;
+                    if (unlikely(free < 0 || free > total || total - free != used[type * nbrelations + id]))
+                        return "Violated isolation or atomicity (reserved units not matching the reservations)";
+                }
+            }
+            if (pool.get_nbnodes() > 0) { // Every preallocated record must be either linked or free, not both
+                auto free = pool.free_nodes(tx);
+                free.insert(free.end(), records.begin(), records.end());
+                ::std::sort(free.begin(), free.end());
+                if (unlikely(free.size() != pool.get_nbnodes() || ::std::adjacent_find(free.begin(), free.end()) != free.end()))
+                    return "Violated isolation or atomicity (leaked or doubly-used reservation record)";
+            }
+            return nullptr;
+        });
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Labyrinth workload class, routing paths in a shared grid (after STAMP's "labyrinth" benchmark).
+ * Each transaction reads a square region of the grid, routes a path between two of its cells over the empty ones, and claims the path cells.
+ * A worker keeps a bounded number of paths, erasing its oldest one in the routing transaction once at the bound.
+**/
+class WorkloadLabyrinth final: public Workload {
+public:
+    /** Cell class alias, holding the ID of the path going through it (0 if empty).
+    **/
+    using Cell = uintptr_t;
+private:
+    /** Laid path class.
+    **/
+    struct Path {
+        Cell                  id;    // Path ID
+        ::std::vector<size_t> cells; // Cell indexes, from source to destination
+    };
+    /** Routing transaction outcome enum.
+    **/
+    enum class Outcome {
+        routed,  // A path was laid
+        blocked, // No path between the chosen cells
+        corrupt  // The erased path did not hold its cells anymore
+    };
+private:
+    size_t nbworkers;  // Number of concurrent workers
+    size_t nbtxperwrk; // Number of transactions per worker
+    size_t side;       // Side of the grid (in cells)
+    size_t region;     // Side of the region read by each transaction (in cells)
+    size_t nbpaths;    // Maximum number of paths kept per worker
+    ::std::unique_ptr<::std::vector<Path>[]> paths; // Per-worker laid paths, oldest first
+    ::std::unique_ptr<Cell[]> counters;             // Per-worker number of paths laid so far (to build unique IDs)
+    ::std::atomic_flag mutable initialized = ATOMIC_FLAG_INIT; // Whether a worker already took care of the initialization
+private:
+    /** Get the address of a cell.
+     * @param index Cell index
+     * @return Cell address
+    **/
+    void* cell(size_t index) const noexcept {
+        return reinterpret_cast<Cell*>(tm.get_start()) + index;
+    }
+    /** Read-write routing transaction.
+     * @param erase  Path to erase first, 'nullptr' for none
+     * @param id     ID of the path to lay
+     * @param origin Grid index of the top-left cell of the region
+     * @param src    Region index of the source cell
+     * @param dst    Region index of the destination cell
+     * @param path   Laid path (output, if routed)
+     * @return Transaction outcome
+    **/
+    Outcome route_tx(Path const* erase, Cell id, size_t origin, size_t src, size_t dst, Path& path) const {
+        ::std::vector<Cell> local(region * region);
+        ::std::vector<size_t> parent(region * region);
+        ::std::vector<size_t> queue;
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            if (erase) {
+                for (auto index: erase->cells) {
+                    Shared<Cell> cell{tx, this->cell(index)};
+                    if (unlikely(cell.read() != erase->id))
+                        return Outcome::corrupt;
+                    cell = 0;
+                }
+            }
+            for (size_t y = 0; y < region; ++y) // Read the whole region
+                tx.read(cell(origin + y * side), region * sizeof(Cell), local.data() + y * region);
+            if (local[src] != 0 || local[dst] != 0)
+                return Outcome::blocked;
+            // Breadth-first expansion from the source, in the private copy
+            auto const none = local.size();
+            ::std::fill(parent.begin(), parent.end(), none);
+            parent[src] = src;
+            queue.assign(1, src);
+            for (size_t head = 0; head < queue.size() && parent[dst] == none; ++head) {
+                auto cur = queue[head];
+                auto x = cur % region;
+                auto y = cur / region;
+                size_t const neighbours[] = {x > 0 ? cur - 1 : none, x + 1 < region ? cur + 1 : none, y > 0 ? cur - region : none, y + 1 < region ? cur + region : none};
+                for (auto next: neighbours) {
+                    if (next != none && parent[next] == none && local[next] == 0) {
+                        parent[next] = cur;
+                        queue.push_back(next);
+                    }
+                }
+            }
+            if (parent[dst] == none)
+                return Outcome::blocked;
+            // Claim the path, backtracking from the destination
+            path.id = id;
+            path.cells.clear();
+            for (auto cur = dst;; cur = parent[cur]) {
+                auto index = origin + (cur / region) * side + cur % region;
+                Shared<Cell>{tx, cell(index)} = id;
+                path.cells.push_back(index);
+                if (cur == src)
+                    break;
+            }
+            ::std::reverse(path.cells.begin(), path.cells.end());
+            return Outcome::routed;
+        });
+    }
+public:
+    /** Labyrinth workload constructor.
+     * @param library    Transactional library to use
+     * @param nbworkers  Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk Number of transactions per worker
+     * @param side       Side of the grid (in cells)
+     * @param region     Side of the region read by each transaction (in cells), in [2, side]
+     * @param nbpaths    Maximum number of paths kept per worker, at least 1
+    **/
+    WorkloadLabyrinth(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t side, size_t region, size_t nbpaths): Workload{library, alignof(Cell), side * side * sizeof(Cell)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, side{side}, region{region}, nbpaths{nbpaths}, paths{new ::std::vector<Path>[nbworkers]}, counters{new Cell[nbworkers]()} {}
+public:
+    /**
+     * Initialize an empty grid, in one transaction run by the first worker only.
+    **/
+    virtual char const* init() const {
+        if (initialized.test_and_set(::std::memory_order_relaxed))
+            return nullptr;
+        ::std::vector<Cell> row(side, 0);
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            for (size_t y = 0; y < side; ++y)
+                tx.write(row.data(), side * sizeof(Cell), cell(y * side));
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            return Shared<Cell>{tx, cell(side * side - 1)}.read() == 0;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk routing transactions, between random cells of random regions.
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_int_distribution<size_t> origin_dist{0, side - region};
+        ::std::uniform_int_distribution<size_t> cell_dist{0, region * region - 1};
+        auto& laid = paths[uid];
+        Path path;
+        auto pacer = arrivals(uid, seed);
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            pacer.arrive();
+            auto const origin = origin_dist(engine) * side + origin_dist(engine);
+            auto const src = cell_dist(engine);
+            auto dst = cell_dist(engine);
+            if (dst == src)
+                dst = (dst + 1) % (region * region);
+            auto const id = uid + 1 + nbworkers * counters[uid]++;
+            auto const erase = laid.size() >= nbpaths;
+            switch (route_tx(erase ? &laid.front() : nullptr, id, origin, src, dst, path)) {
+            case Outcome::corrupt:
+                return "Violated isolation or atomicity (path cells overwritten)";
+            case Outcome::routed:
+                if (erase)
+                    laid.erase(laid.begin());
+                laid.push_back(::std::move(path));
+                break;
+            default: // Outcome::blocked
+                if (erase)
+                    laid.erase(laid.begin());
+                break;
+            }
+            pacer.depart();
+        }
+        return nullptr;
+    }
+    /**
+     * Check that the grid holds exactly the paths laid by the workers, in one read-only transaction.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        ::std::vector<Cell> expected(side * side, 0);
+        for (size_t i = 0; i < nbworkers; ++i) {
+            for (auto&& path: paths[i]) {
+                for (size_t j = 0; j < path.cells.size(); ++j) {
+                    auto index = path.cells[j];
+                    if (j > 0) { // Consecutive cells must be adjacent
+                        auto prev = path.cells[j - 1];
+                        if (unlikely(index != prev + 1 && index + 1 != prev && index != prev + side && index + side != prev))
+                            return "Violated consistency (disconnected path)";
+                    }
+                    if (unlikely(expected[index] != 0))
+                        return "Violated isolation or atomicity (paths sharing a cell)";
+                    expected[index] = path.id;
+                }
+            }
+        }
+        ::std::vector<Cell> grid(side * side);
+        transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            tx.read(cell(0), side * side * sizeof(Cell), grid.data());
+        });
+        if (unlikely(grid != expected))
+            return "Violated isolation or atomicity (grid not matching the laid paths)";
+        return nullptr;
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Large-block workload class, reading and rewriting whole multi-word records with large 'tm_read'/'tm_write' accesses.
+**/
+class WorkloadBlocks final: public Workload {
+public:
+    /** Word class alias, a record holding 'stamp ^ (index * mixer)' at each word index.
+    **/
+    using Word = uintptr_t;
+    constexpr static auto mixer = Word{0x9e3779b97f4a7c15ull};
+private:
+    size_t nbtxperwrk;  // Number of transactions per worker
+    size_t nbrecords;   // Number of records
+    size_t nbwords;     // Number of words per record
+    size_t nbchunk;     // Number of words per 'tm_read'/'tm_write' call, dividing the number of words per record
+    float  prob_update; // Probability of rewriting a record, instead of only reading it
+    ::std::atomic_flag mutable initialized = ATOMIC_FLAG_INIT; // Whether a worker already took care of the initialization
+private:
+    /** Get the address of a record.
+     * @param index Record index
+     * @return Record address
+    **/
+    void* record(size_t index) const noexcept {
+        return reinterpret_cast<Word*>(tm.get_start()) + index * nbwords;
+    }
+    /** Read a whole record, chunk by chunk.
+     * @param tx     Associated pending transaction
+     * @param index  Record index
+     * @param buffer Private buffer of the record size
+    **/
+    void read(Transaction& tx, size_t index, Word* buffer) const {
+        auto source = reinterpret_cast<Word*>(record(index));
+        for (size_t i = 0; i < nbwords; i += nbchunk)
+            tx.read(source + i, nbchunk * sizeof(Word), buffer + i);
+    }
+    /** Write a whole record, chunk by chunk.
+     * @param tx     Associated pending transaction
+     * @param index  Record index
+     * @param buffer Private buffer of the record size
+    **/
+    void write(Transaction& tx, size_t index, Word const* buffer) const {
+        auto target = reinterpret_cast<Word*>(record(index));
+        for (size_t i = 0; i < nbwords; i += nbchunk)
+            tx.write(buffer + i, nbchunk * sizeof(Word), target + i);
+    }
+    /** Check that a record copy holds a single stamp.
+     * @param buffer Record copy
+     * @return Whether the record is consistent
+    **/
+    bool consistent(Word const* buffer) const noexcept {
+        auto const stamp = buffer[0];
+        for (size_t i = 1; i < nbwords; ++i) {
+            if (unlikely(buffer[i] != (stamp ^ (i * mixer))))
+                return false;
+        }
+        return true;
+    }
+public:
+    /** Large-block workload constructor.
+     * @param library     Transactional library to use
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbrecords   Number of records
+     * @param nbwords     Number of words per record
+     * @param nbchunk     Number of words per 'tm_read'/'tm_write' call, dividing the number of words per record
+     * @param prob_update Probability of rewriting a record, instead of only reading it
+    **/
+    WorkloadBlocks(TransactionalLibrary const& library, size_t nbtxperwrk, size_t nbrecords, size_t nbwords, size_t nbchunk, float prob_update): Workload{library, alignof(Word), nbrecords * nbwords * sizeof(Word)}, nbtxperwrk{nbtxperwrk}, nbrecords{nbrecords}, nbwords{nbwords}, nbchunk{nbchunk}, prob_update{prob_update} {}
+public:
+    /**
+     * Initialize every record with stamp 0, in one transaction run by the first worker only.
+    **/
+    virtual char const* init() const {
+        if (initialized.test_and_set(::std::memory_order_relaxed))
+            return nullptr;
+        ::std::vector<Word> buffer(nbwords);
+        for (size_t i = 0; i < nbwords; ++i)
+            buffer[i] = i * mixer;
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            for (size_t i = 0; i < nbrecords; ++i)
+                write(tx, i, buffer.data());
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            read(tx, nbrecords - 1, buffer.data());
+            return buffer[0] == 0 && consistent(buffer.data());
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk whole-record reads (read-only) or rewrites (read-write, with a new stamp).
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::uniform_int_distribution<size_t> record_dist{0, nbrecords - 1};
+        ::std::vector<Word> buffer(nbwords);
+        auto pacer = arrivals(uid, seed);
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            pacer.arrive();
+            auto const index = record_dist(engine);
+            bool correct;
+            if (update_dist(engine)) {
+                auto const stamp = static_cast<Word>(engine());
+                correct = transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+                    read(tx, index, buffer.data());
+                    if (unlikely(!consistent(buffer.data())))
+                        return false;
+                    for (size_t i = 0; i < nbwords; ++i)
+                        buffer[i] = stamp ^ (i * mixer);
+                    write(tx, index, buffer.data());
+                    return true;
+                });
+            } else {
+                correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+                    read(tx, index, buffer.data());
+                    return consistent(buffer.data());
+                });
+            }
+            if (unlikely(!correct))
+                return "Violated isolation or atomicity (torn record)";
+            pacer.depart();
+        }
+        return nullptr;
+    }
+    /**
+     * Check that every record holds a single stamp, in one read-only transaction.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        ::std::vector<Word> buffer(nbwords);
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            for (size_t i = 0; i < nbrecords; ++i) {
+                read(tx, i, buffer.data());
+                if (unlikely(!consistent(buffer.data())))
+                    return false;
+            }
+            return true;
+        });
+        if (unlikely(!correct))
+            return "Violated isolation or atomicity (torn record)";
+        return nullptr;
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Allocation churn workload class, where most transactions allocate and/or free variable-size segments.
+ * Allocated segments are kept in transactional LIFO lists, each segment linking to the next and holding its own size.
+**/
+class WorkloadChurn final: public Workload {
+public:
+    /** Word class alias.
+    **/
+    using Word = uintptr_t;
+    constexpr static auto mixer = Word{0x9e3779b97f4a7c15ull}; // Mixed with the size in the last word of a segment
+    constexpr static size_t header = 3; // Minimum number of words per segment: next, size and stamp
+private:
+    /** Shared list class, in the first segment.
+    **/
+    class List final {
+    public:
+        /** Get the list size.
+         * @return List size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(void*) + sizeof(size_t);
+        }
+    public:
+        Shared<void*>  head;  // First segment, 'nullptr' if empty
+        Shared<size_t> count; // Number of segments
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        List(List const&) = delete;
+        List& operator=(List const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address List base address
+        **/
+        List(Transaction& tx, void* address): head{tx, address}, count{tx, head.after()} {}
+    };
+    /** Per-worker operation counters class.
+    **/
+    struct alignas(64) Counts { // Avoid false sharing between workers
+        uint64_t allocs; // Committed allocations
+        uint64_t frees;  // Committed frees
+    };
+private:
+    size_t nbworkers;  // Number of concurrent workers
+    size_t nbtxperwrk; // Number of transactions per worker
+    size_t nblists;    // Number of lists
+    size_t capacity;   // Maximum number of segments per list
+    size_t min_words;  // Minimum segment size (in words)
+    size_t max_words;  // Maximum segment size (in words)
+    ::std::unique_ptr<Counts[]> counts; // Per-worker operation counters since initialization
+    ::std::atomic_flag mutable initialized = ATOMIC_FLAG_INIT; // Whether a worker already took care of the initialization
+private:
+    /** Get the address of a list.
+     * @param index List index
+     * @return List address
+    **/
+    void* list(size_t index) const noexcept {
+        return reinterpret_cast<char*>(tm.get_start()) + index * List::size();
+    }
+    /** Pop and free the first segment of a list, verifying its header.
+     * @param tx   Associated pending transaction
+     * @param list Bound list, not empty
+     * @return Whether the segment header was intact
+    **/
+    bool pop(Transaction& tx, List const& list) const {
+        void* segment = list.head;
+        Shared<void*>  next{tx, segment};
+        Shared<size_t> size{tx, next.after()};
+        size_t words = size;
+        if (unlikely(words < header || words > max_words))
+            return false;
+        if (unlikely(Shared<Word>(tx, reinterpret_cast<Word*>(segment) + words - 1).read() != (words ^ mixer)))
+            return false;
+        list.head  = next.read();
+        list.count = list.count.read() - 1;
+        tx.free(segment);
+        return true;
+    }
+    /** Allocate and push a segment on a list.
+     * @param tx    Associated pending transaction
+     * @param list  Bound list, not full
+     * @param words Segment size (in words)
+    **/
+    void push(Transaction& tx, List const& list, size_t words) const {
+        auto segment = tx.alloc(words * sizeof(Word));
+        Shared<void*>  next{tx, segment};
+        Shared<size_t> size{tx, next.after()};
+        next = list.head.read();
+        size = words;
+        Shared<Word>{tx, reinterpret_cast<Word*>(segment) + words - 1} = words ^ mixer;
+        list.head  = segment;
+        list.count = list.count.read() + 1;
+    }
+public:
+    /** Allocation churn workload constructor.
+     * @param library    Transactional library to use
+     * @param nbworkers  Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk Number of transactions per worker
+     * @param nblive     Maximum number of live segments (besides the first one)
+     * @param min_size   Minimum segment size (in bytes, at least 'header' words)
+     * @param max_size   Maximum segment size (in bytes)
+    **/
+    WorkloadChurn(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nblive, size_t min_size, size_t max_size): Workload{library, alignof(Word), ::std::min(nbworkers, nblive) * List::size()}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nblists{::std::min(nbworkers, nblive)}, capacity{nblive / ::std::min(nbworkers, nblive)}, min_words{min_size / sizeof(Word)}, max_words{max_size / sizeof(Word)}, counts{new Counts[nbworkers]()} {}
+public:
+    /**
+     * Initialize empty lists, in one transaction run by the first worker only.
+    **/
+    virtual char const* init() const {
+        if (initialized.test_and_set(::std::memory_order_relaxed))
+            return nullptr;
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            for (size_t i = 0; i < nblists; ++i) {
+                List list{tx, this->list(i)};
+                list.head  = nullptr;
+                list.count = 0;
+            }
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            return List{tx, list(nblists - 1)}.head.read() == nullptr;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk transactions on random lists, each allocating a segment, freeing one, or freeing one then allocating another.
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_int_distribution<size_t> list_dist{0, nblists - 1};
+        ::std::uniform_int_distribution<size_t> size_dist{min_words, max_words};
+        ::std::uniform_int_distribution<int> op_dist{0, 2}; // Allocate, free, or both
+        auto& count = counts[uid];
+        auto pacer = arrivals(uid, seed);
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            pacer.arrive();
+            auto const index = list_dist(engine);
+            auto const words = size_dist(engine);
+            auto const op    = op_dist(engine);
+            uint64_t allocs = 0;
+            uint64_t frees  = 0;
+            auto correct = transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+                allocs = 0;
+                frees  = 0;
+                List list{tx, this->list(index)};
+                size_t length = list.count;
+                if (length > 0 && (op != 0 || length >= capacity)) { // Free, unless only allocating and not full
+                    if (unlikely(!pop(tx, list)))
+                        return false;
+                    ++frees;
+                    --length;
+                }
+                if (length < capacity && (op != 1 || frees == 0)) { // Allocate, unless only freeing and did free
+                    push(tx, list, words);
+                    ++allocs;
+                }
+                return true;
+            });
+            if (unlikely(!correct))
+                return "Violated isolation or atomicity (corrupted segment header)";
+            count.allocs += allocs;
+            count.frees  += frees;
+            pacer.depart();
+        }
+        return nullptr;
+    }
+    /**
+     * Check that the lists hold every allocated and not freed segment exactly once, with intact headers, in one read-only transaction.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            ::std::vector<void*> segments;
+            for (size_t i = 0; i < nblists; ++i) {
+                List list{tx, this->list(i)};
+                size_t length = 0;
+                for (void* cur = list.head; cur; cur = Shared<void*>{tx, cur}.read()) {
+                    if (unlikely(++length > capacity))
+                        return "Violated consistency (cyclic or overfull segment list)";
+                    size_t words = Shared<size_t>{tx, reinterpret_cast<Word*>(cur) + 1};
+                    if (unlikely(words < min_words || words > max_words || Shared<Word>(tx, reinterpret_cast<Word*>(cur) + words - 1).read() != (words ^ mixer)))
+                        return "Violated isolation or atomicity (corrupted segment header)";
+                    segments.push_back(cur);
+                }
+                if (unlikely(length != list.count.read()))
+                    return "Violated atomicity (segment list length not matching its count)";
+            }
+            ::std::sort(segments.begin(), segments.end());
+            if (unlikely(::std::adjacent_find(segments.begin(), segments.end()) != segments.end()))
+                return "Violated isolation or atomicity (segment listed twice, i.e. double free or double allocation)";
+            uint64_t allocs = 0;
+            uint64_t frees  = 0;
+            for (size_t i = 0; i < nbworkers; ++i) {
+                allocs += counts[i].allocs;
+                frees  += counts[i].frees;
+            }
+            if (unlikely(allocs - frees != segments.size()))
+                return "Violated atomicity (listed segments not matching the committed allocations and frees)";
+            return nullptr;
+        });
+    }
+    /** Print the committed allocation and free rates.
+     * @param seconds Total duration of the measured runs (in s)
+    **/
+    virtual void report(double seconds) const {
+        uint64_t allocs = 0;
+        uint64_t frees  = 0;
+        for (size_t i = 0; i < nbworkers; ++i) {
+            allocs += counts[i].allocs;
+            frees  += counts[i].frees;
+        }
+        ::std::cout << "⎪ Segment allocations:       " << (static_cast<double>(allocs) / seconds) << " /s, frees " << (static_cast<double>(frees) / seconds) << " /s" << ::std::endl;
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Recorded trace class, the committed transactions of each recorded thread as read from a trace file (see 'trace.h').
+**/
+class Trace final {
+public:
+    /** Replayed shared memory access class.
+    **/
+    struct Access {
+        uint64_t offset;  // Offset in the segment (in bytes)
+        uint64_t size;    // Accessed or allocated size (in bytes)
+        uint32_t segment; // Segment ID
+        uint8_t  op;      // Operation, in 'tm_trace_op' (neither begin nor end)
+    };
+    /** Committed transaction class.
+    **/
+    struct Tx {
+        Chrono::Tick          time;     // Begin time, since the first recorded begin (in ns)
+        bool                  ro;       // Whether the transaction is read-only
+        ::std::vector<Access> accesses; // Accesses, in order
+    };
+public:
+    uint64_t size;       // Size of the first segment (in bytes)
+    uint64_t align;      // Alignment of the shared memory region (in bytes)
+    ::std::vector<uint64_t> segments; // Size of each segment (in bytes), by ID
+    ::std::vector<::std::vector<Tx>> threads; // Committed transactions of each recorded thread, in order
+    size_t nbtxs;        // Number of committed transactions
+    size_t nbaccesses;   // Number of accesses in the committed transactions
+    size_t nbdropped;    // Number of dropped accesses (out of any segment, or overflowing it)
+    uint64_t max_access; // Size of the largest read or write (in bytes)
+public:
+    /** Loading constructor.
+     * @param path Path of the trace file
+    **/
+    Trace(::std::string const& path): nbtxs{0}, nbaccesses{0}, nbdropped{0}, max_access{0} {
+        ::std::ifstream file{path, ::std::ios::binary};
+        if (unlikely(!file))
+            throw Exception::TraceOpen{};
+        tm_trace_header header;
+        if (unlikely(!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || ::std::memcmp(header.magic, TM_TRACE_MAGIC, sizeof(TM_TRACE_MAGIC)) != 0 || header.version != TM_TRACE_VERSION || header.nbsegments == 0 || header.align == 0 || header.size % header.align != 0))
+            throw Exception::TraceFormat{};
+        size  = header.size;
+        align = header.align;
+        segments.assign(header.nbsegments, 0);
+        segments[0] = size;
+        threads.resize(header.nbthreads);
+        ::std::vector<Tx> pending(header.nbthreads); // Attempt in progress of each thread
+        ::std::vector<bool> running(header.nbthreads, false);
+        auto origin = ~Chrono::Tick{0};
+        ::std::vector<tm_trace_record> records(4096);
+        /** Read every record, in file order.
+         * @param func Record closure (tm_trace_record const& -> void)
+        **/
+        auto const scan = [&](auto&& func) {
+            file.clear();
+            file.seekg(sizeof(header));
+            for (uint64_t left = header.nbrecords; left > 0;) {
+                auto const count = static_cast<size_t>(::std::min<uint64_t>(left, records.size()));
+                if (unlikely(!file.read(reinterpret_cast<char*>(records.data()), static_cast<::std::streamsize>(count * sizeof(tm_trace_record)))))
+                    throw Exception::TraceFormat{};
+                left -= count;
+                for (size_t i = 0; i < count; ++i) {
+                    if (unlikely(records[i].thread >= header.nbthreads))
+                        throw Exception::TraceFormat{};
+                    func(records[i]);
+                }
+            }
+        };
+        scan([&](tm_trace_record const& rec) { // Segment sizes first, as threads' records are interleaved in chunks
+            if (rec.op == tm_trace_alloc && (rec.flags & TM_TRACE_SUCCESS) != 0) {
+                if (unlikely(rec.segment == 0 || rec.segment >= segments.size()))
+                    throw Exception::TraceFormat{};
+                segments[rec.segment] = rec.size;
+            }
+        });
+        scan([&](tm_trace_record const& rec) {
+            auto& tx = pending[rec.thread];
+            auto const success = (rec.flags & TM_TRACE_SUCCESS) != 0;
+            if (rec.op == tm_trace_begin) {
+                running[rec.thread] = success;
+                tx.time = rec.time;
+                tx.ro   = (rec.flags & TM_TRACE_RO) != 0;
+                tx.accesses.clear();
+                return;
+            }
+            if (!running[rec.thread])
+                return;
+            if (!success) { // Aborted attempt, retried by the application as a new transaction
+                running[rec.thread] = false;
+                return;
+            }
+            switch (rec.op) {
+            case tm_trace_end:
+                running[rec.thread] = false;
+                origin = ::std::min<Chrono::Tick>(origin, tx.time);
+                nbaccesses += tx.accesses.size();
+                threads[rec.thread].push_back(::std::move(tx));
+                tx = Tx{};
+                break;
+            case tm_trace_alloc:
+                tx.accesses.push_back(Access{0, rec.size, rec.segment, rec.op});
+                break;
+            case tm_trace_free:
+                if (rec.segment == 0 || rec.segment >= segments.size()) {
+                    ++nbdropped;
+                    break;
+                }
+                tx.accesses.push_back(Access{0, 0, rec.segment, rec.op});
+                break;
+            case tm_trace_read:
+            case tm_trace_write:
+                if (rec.segment >= segments.size() || rec.size == 0 || rec.offset % align != 0 || rec.size % align != 0 || rec.offset + rec.size > segments[rec.segment]) { // Out of any segment, or misaligned
+                    ++nbdropped;
+                    break;
+                }
+                max_access = ::std::max(max_access, rec.size);
+                tx.accesses.push_back(Access{rec.offset, rec.size, rec.segment, rec.op});
+                break;
+            default:
+                throw Exception::TraceFormat{};
+            }
+        });
+        for (auto&& txs: threads) {
+            nbtxs += txs.size();
+            for (auto&& tx: txs)
+                tx.time -= origin;
+        }
+    }
+};
+
+/** Trace replay workload class.
+**/
+class WorkloadReplay final: public Workload {
+private:
+    /** Per-worker replay counters class.
+    **/
+    struct alignas(64) Counts { // Avoid false sharing between workers
+        uint64_t replayed; // Committed transactions
+        uint64_t skipped;  // Accesses and frees skipped, their segment not being (yet, or anymore) allocated
+        uint64_t refused;  // Transactions given up, their allocations being refused
+    };
+    constexpr static size_t max_alloc_retries = 16; // Number of attempts of a transaction whose allocation aborts before giving it up
+private:
+    size_t nbworkers; // Number of concurrent workers
+    ::std::shared_ptr<Trace const> trace; // Replayed trace
+    bool pace;        // Whether to start each transaction at its recorded time
+    ::std::vector<::std::vector<Trace::Tx const*>> schedules; // Transactions of each worker, by begin time
+    ::std::unique_ptr<::std::atomic<void*>[]> segments; // Replay address of each segment, 'nullptr' if not allocated
+    ::std::unique_ptr<Counts[]> counts; // Per-worker counters since construction
+    Barrier barrier; // Barrier for the end-of-run frees
+private:
+    /** Replay one committed transaction until it commits, or its allocations keep being refused.
+     * Segments to free are unlisted before the transaction begins, so that transactions replayed afterwards skip their accesses.
+     * @param uid    Id of the replaying worker
+     * @param trans  Transaction to replay
+     * @param buffer Private buffer, large enough for any access
+    **/
+    void replay(Uid uid, Trace::Tx const& trans, void* buffer) const {
+        auto& count = counts[uid];
+        ::std::vector<::std::pair<uint32_t, void*>> allocated; // Segments allocated by the current attempt
+        ::std::vector<::std::pair<uint32_t, void*>> freed;     // Segments unlisted to be freed by the transaction
+        for (auto&& access: trans.accesses) {
+            if (access.op == tm_trace_free) {
+                auto segment = segments[access.segment].exchange(nullptr, ::std::memory_order_acq_rel);
+                if (segment)
+                    freed.emplace_back(access.segment, segment);
+            }
+        }
+        for (size_t attempt = 0;; ++attempt) {
+            auto refused = false;
+            uint64_t skipped = 0;
+            try {
+                ++transaction_counters.begun;
+                Transaction tx{tm, trans.ro ? Transaction::Mode::read_only : Transaction::Mode::read_write};
+                allocated.clear();
+                for (auto&& access: trans.accesses) {
+                    if (access.op == tm_trace_alloc) {
+                        refused = true;
+                        allocated.emplace_back(access.segment, tx.alloc(access.size));
+                        refused = false;
+                        continue;
+                    }
+                    if (access.op == tm_trace_free) {
+                        auto seg = ::std::find_if(allocated.begin(), allocated.end(), [&](auto const& seg) { return seg.first == access.segment; });
+                        if (seg != allocated.end()) { // Allocated by this very transaction
+                            tx.free(seg->second);
+                            allocated.erase(seg);
+                            continue;
+                        }
+                        seg = ::std::find_if(freed.begin(), freed.end(), [&](auto const& seg) { return seg.first == access.segment; });
+                        if (seg != freed.end()) {
+                            tx.free(seg->second);
+                        } else {
+                            ++skipped;
+                        }
+                        continue;
+                    }
+                    void* base = segments[access.segment].load(::std::memory_order_acquire);
+                    for (auto&& seg: allocated) {
+                        if (seg.first == access.segment)
+                            base = seg.second;
+                    }
+                    if (!base) {
+                        ++skipped;
+                        continue;
+                    }
+                    auto shared = reinterpret_cast<char*>(base) + access.offset;
+                    if (access.op == tm_trace_read) {
+                        tx.read(shared, access.size, buffer);
+                    } else {
+                        tx.write(buffer, access.size, shared);
+                    }
+                }
+            } catch (Exception::TransactionRetry const&) {
+                ++transaction_counters.aborted;
+                if (refused && attempt + 1 >= max_alloc_retries) {
+                    for (auto&& seg: freed) // Not freed after all
+                        segments[seg.first].store(seg.second, ::std::memory_order_release);
+                    ++count.refused;
+                    return;
+                }
+                continue;
+            }
+            for (auto&& seg: allocated)
+                segments[seg.first].store(seg.second, ::std::memory_order_release);
+            ++count.replayed;
+            count.skipped += skipped;
+            return;
+        }
+    }
+public:
+    /** Trace replay workload constructor.
+     * @param library   Transactional library to use
+     * @param nbworkers Total number of concurrent threads (for both 'run' and 'check'), recorded thread i being replayed by worker i % nbworkers
+     * @param trace     Trace to replay
+     * @param pace      Whether to start each transaction at its recorded time, instead of as soon as possible
+    **/
+    WorkloadReplay(TransactionalLibrary const& library, size_t nbworkers, ::std::shared_ptr<Trace const> trace, bool pace): Workload{library, trace->align, trace->size}, nbworkers{nbworkers}, trace{trace}, pace{pace}, schedules(nbworkers), segments{new ::std::atomic<void*>[trace->segments.size()]}, counts{new Counts[nbworkers]()}, barrier{static_cast<Barrier::Counter>(nbworkers)} {
+        for (size_t i = 0; i < trace->threads.size(); ++i) {
+            for (auto&& tx: trace->threads[i])
+                schedules[i % nbworkers].push_back(&tx);
+        }
+        for (auto&& schedule: schedules)
+            ::std::stable_sort(schedule.begin(), schedule.end(), [](Trace::Tx const* a, Trace::Tx const* b) { return a->time < b->time; });
+        segments[0].store(tm.get_start(), ::std::memory_order_relaxed);
+        for (size_t i = 1; i < trace->segments.size(); ++i)
+            segments[i].store(nullptr, ::std::memory_order_relaxed);
+    }
+public:
+    /**
+     * Nothing to initialize, the first segment starting zeroed as when recorded.
+    **/
+    virtual char const* init() const {
+        return nullptr;
+    }
+    /**
+     * Replay the committed transactions of the recorded threads assigned to this worker, then free the segments the run left allocated.
+     * @param uid  Id of the thread running the transactions
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::vector<char> storage(trace->max_access + trace->align);
+        auto buffer = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(storage.data()) + trace->align - 1) / trace->align * trace->align);
+        auto pacer = arrivals(uid, seed);
+        Chrono clock;
+        clock.start();
+        for (auto tx: schedules[uid]) {
+            if (pace) {
+                while (clock.delta() < tx->time)
+                    ::std::this_thread::yield();
+            }
+            pacer.arrive();
+            replay(uid, *tx, buffer);
+            pacer.depart();
+        }
+        barrier.sync(); // Nobody replays anymore, free what the trace did not
+        for (size_t i = 1 + uid; i < trace->segments.size(); i += nbworkers) {
+            void* segment = segments[i].load(::std::memory_order_relaxed);
+            if (!segment)
+                continue;
+            transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+                tx.free(segment);
+            });
+            segments[i].store(nullptr, ::std::memory_order_relaxed);
+        }
+        return nullptr;
+    }
+    /**
+     * Check that the first segment can still be read entirely, in one read-only transaction.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        if (uid != 0) // Only the first thread checks the shared memory.
+            return nullptr;
+        ::std::vector<char> storage(trace->size + trace->align);
+        auto buffer = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(storage.data()) + trace->align - 1) / trace->align * trace->align);
+        transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            tx.read(tm.get_start(), trace->size, buffer);
+        });
+        for (size_t i = 1; i < trace->segments.size(); ++i) {
+            if (unlikely(segments[i].load(::std::memory_order_relaxed)))
+                return "Violated atomicity (segment allocated by a run still listed after its end-of-run free)";
+        }
+        return nullptr;
+    }
+    /** Print the replayed transaction rate and the skipped work.
+     * @param seconds Total duration of the measured runs (in s)
+    **/
+    virtual void report(double seconds) const {
+        uint64_t replayed = 0;
+        uint64_t skipped  = 0;
+        uint64_t refused  = 0;
+        for (size_t i = 0; i < nbworkers; ++i) {
+            replayed += counts[i].replayed;
+            skipped  += counts[i].skipped;
+            refused  += counts[i].refused;
+        }
+        ::std::cout << "⎪ Replayed TX:               " << (static_cast<double>(replayed) / seconds) << " TX/s, " << skipped << " access(es) skipped (segment not allocated), " << refused << " TX given up (allocation refused)" << ::std::endl;
+    }
+    /** Tell that the runs cannot be serialized, each one waiting for every worker at its end-of-run frees.
+     * @return False
+    **/
+    virtual bool can_run_serially() const noexcept {
+        return false;
+    }
+};
@@ -0,0 +1,80 @@
+/**
+ * @file   trace.h
+ * @author Will Yu (?@epfl.ch)
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Binary trace format of the tm_* calls, written by the recorder library and replayed by the grader.
+ *
+ * A trace file is one 'tm_trace_header' followed by 'nbrecords' fixed-size 'tm_trace_record's, in host
+ * byte order. Records of one thread appear in call order; records of different threads are interleaved
+ * in chunks. Shared addresses are stored as (segment, offset) pairs, the first segment having ID 0 and
+ * each successful 'tm_alloc' taking the next ID, so a trace can be replayed on any implementation.
+**/
+
+#pragma once
+
+#include <stdint.h>
+
+// -------------------------------------------------------------------------- //
+
+#define TM_TRACE_MAGIC   "TMTRACE"
+#define TM_TRACE_VERSION 1
+
+/** Recorded operation enum.
+**/
+enum tm_trace_op {
+    tm_trace_begin, // 'tm_begin', 'flags' has 'tm_trace_ro' for a read-only transaction
+    tm_trace_end,   // 'tm_end'
+    tm_trace_read,  // 'tm_read' of 'size' bytes at ('segment', 'offset')
+    tm_trace_write, // 'tm_write' of 'size' bytes at ('segment', 'offset')
+    tm_trace_alloc, // 'tm_alloc' of 'size' bytes, creating segment 'segment'
+    tm_trace_free   // 'tm_free' of segment 'segment'
+};
+
+/** Record flags.
+**/
+#define TM_TRACE_SUCCESS 0x1 // The call succeeded (did not abort the transaction)
+#define TM_TRACE_RO      0x2 // The transaction is read-only
+
+/** Segment ID of addresses out of any known segment.
+**/
+#define TM_TRACE_NO_SEGMENT UINT32_MAX
+
+/** Trace file header.
+**/
+struct tm_trace_header {
+    char     magic[8];   // 'TM_TRACE_MAGIC', null-terminated
+    uint32_t version;    // 'TM_TRACE_VERSION'
+    uint32_t nbthreads;  // Number of recorded threads, IDs being in [0, nbthreads[
+    uint64_t size;       // Size of the first segment (in bytes)
+    uint64_t align;      // Alignment of the shared memory region (in bytes)
+    uint64_t nbsegments; // Number of segment IDs, the first segment included
+    uint64_t nbrecords;  // Number of records following the header
+};
+
+/** Trace record, one per tm_* call.
+**/
+struct tm_trace_record {
+    uint64_t time;    // Time of the call, since the region creation (in ns)
+    uint64_t offset;  // Offset in the segment (in bytes)
+    uint64_t size;    // Accessed or allocated size (in bytes)
+    uint32_t segment; // Accessed, allocated or freed segment ID
+    uint16_t thread;  // Calling thread ID
+    uint8_t  op;      // Operation, in 'enum tm_trace_op'
+    uint8_t  flags;   // Combination of 'TM_TRACE_*' flags
+};
@@ -0,0 +1,500 @@
+/**
+ * @file   microbench.cpp
+ * @author Will Yu (?@epfl.ch)
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Microbenchmarks of the individual tm_* operations, each run in a tight loop at increasing thread counts,
+ * and of the epoch turnover (commit and blocked-waiter latency) at increasing region sizes.
+**/
+
+// External headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+#include "stats.hpp"
+#include "transactional.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Microbenchmark class, one primitive run in a loop by every thread on its own slice of the first segment.
+**/
+struct Microbench {
+    /** Benchmark loop type.
+     * @param tm    Transactional memory to use
+     * @param slice Start address of the thread's slice of the first segment
+     * @param count Number of operations to run
+     * @param buf   Private buffer, large enough for any access
+     * @return Number of transactions aborted (and retried)
+    **/
+    using Loop = ::std::function<uint64_t(TransactionalMemory const& tm, void* slice, size_t count, void* buf)>;
+    ::std::string name;  // Benchmark name
+    char const*   unit;  // Measured operation
+    size_t        slice; // Size of each thread's slice of the first segment (in bytes)
+    Loop          loop;  // Benchmark loop
+};
+
+/** Run one transaction until it commits.
+ * @param tm   Transactional memory to use
+ * @param ro   Whether the transaction is read-only
+ * @param body Transaction body (TransactionalMemory::TX -> bool, whether the transaction can continue)
+ * @return Number of aborted attempts
+**/
+template<class Body> static uint64_t commit(TransactionalMemory const& tm, bool ro, Body&& body) {
+    uint64_t aborts = 0;
+    while (true) {
+        auto tx = tm.begin(ro);
+        if (unlikely(tx == STM::invalid_tx)) {
+            ++aborts;
+            continue;
+        }
+        if (likely(body(tx) && tm.end(tx)))
+            return aborts;
+        ++aborts;
+    }
+}
+
+/** Build the list of microbenchmarks.
+ * @param align    Alignment, i.e. word size (in bytes)
+ * @param max_size Largest access size (in bytes)
+ * @param batch    Number of accesses per transaction in the access benchmarks
+ * @return Microbenchmarks
+**/
+static ::std::vector<Microbench> microbenches(size_t align, size_t max_size, size_t batch) {
+    ::std::vector<Microbench> res;
+    for (auto ro: {true, false}) {
+        res.push_back(Microbench{::std::string{"begin-end/"} + (ro ? "ro" : "rw"), "TX", align, [ro](TransactionalMemory const& tm, void*, size_t count, void*) {
+            uint64_t aborts = 0;
+            for (size_t i = 0; i < count; ++i)
+                aborts += commit(tm, ro, [](TransactionalMemory::TX) { return true; });
+            return aborts;
+        }});
+    }
+    for (auto write: {false, true}) {
+        for (size_t size = align; size <= max_size; size *= 8) {
+            res.push_back(Microbench{::std::string{write ? "write/" : "read/"} + ::std::to_string(size), "access", batch * size, [write, size, batch](TransactionalMemory const& tm, void* slice, size_t count, void* buf) {
+                uint64_t aborts = 0;
+                for (size_t done = 0; done < count; done += batch) {
+                    auto const nbaccesses = ::std::min(batch, count - done);
+                    aborts += commit(tm, !write, [&](TransactionalMemory::TX tx) {
+                        for (size_t i = 0; i < nbaccesses; ++i) {
+                            auto addr = reinterpret_cast<char*>(slice) + i * size;
+                            if (unlikely(!(write ? tm.write(tx, buf, size, addr) : tm.read(tx, addr, size, buf))))
+                                return false;
+                        }
+                        return true;
+                    });
+                }
+                return aborts;
+            }});
+        }
+    }
+    res.push_back(Microbench{"commit/1-write", "TX", align, [align](TransactionalMemory const& tm, void* slice, size_t count, void* buf) {
+        uint64_t aborts = 0;
+        for (size_t i = 0; i < count; ++i)
+            aborts += commit(tm, false, [&](TransactionalMemory::TX tx) { return tm.write(tx, buf, align, slice); });
+        return aborts;
+    }});
+    res.push_back(Microbench{"alloc-free/" + ::std::to_string(8 * align), "alloc+free", align, [align](TransactionalMemory const& tm, void*, size_t count, void*) {
+        uint64_t aborts = 0;
+        for (size_t i = 0; i < count; ++i) {
+            void* segment = nullptr;
+            aborts += commit(tm, false, [&](TransactionalMemory::TX tx) { return tm.alloc(tx, 8 * align, &segment) == STM::Alloc::success; });
+            aborts += commit(tm, false, [&](TransactionalMemory::TX tx) { return tm.free(tx, segment); });
+        }
+        return aborts;
+    }});
+    return res;
+}
+
+/** Measurement of one microbenchmark at one thread count.
+**/
+struct Measure {
+    ::std::vector<double> times; // Duration of each measured repetition (in ns)
+    uint64_t aborts;             // Aborted transactions over all the repetitions, warmup included
+};
+
+/** Run one microbenchmark at one thread count, on a fresh shared memory region.
+ * @param tl         Transactional library to use
+ * @param bench      Microbenchmark to run
+ * @param align      Alignment (in bytes)
+ * @param buf_size   Size of each thread's private buffer (in bytes)
+ * @param nbthreads  Number of threads
+ * @param count      Number of operations per thread and repetition
+ * @param nbwarmups  Number of unmeasured repetitions
+ * @param nbrepeats  Number of measured repetitions
+ * @return Measurement
+**/
+static Measure measure(TransactionalLibrary const& tl, Microbench const& bench, size_t align, size_t buf_size, size_t nbthreads, size_t count, size_t nbwarmups, size_t nbrepeats) {
+    TransactionalMemory tm{tl, align, nbthreads * bench.slice};
+    Barrier barrier{static_cast<Barrier::Counter>(nbthreads)};
+    Measure res{{}, 0};
+    ::std::atomic<uint64_t> aborts{0};
+    Chrono chrono;
+    ::std::vector<::std::thread> threads;
+    for (size_t uid = 0; uid < nbthreads; ++uid) {
+        threads.emplace_back([&, uid]() {
+            ::std::unique_ptr<uint64_t[]> buf{new uint64_t[buf_size / sizeof(uint64_t) + 1]()};
+            auto slice = reinterpret_cast<char*>(tm.get_start()) + uid * bench.slice;
+            uint64_t local = 0;
+            for (size_t rep = 0; rep < nbwarmups + nbrepeats; ++rep) {
+                barrier.sync();
+                if (uid == 0)
+                    chrono.start();
+                local += bench.loop(tm, slice, count, buf.get());
+                barrier.sync();
+                if (uid == 0 && rep >= nbwarmups)
+                    res.times.push_back(static_cast<double>(chrono.delta()));
+            }
+            aborts.fetch_add(local, ::std::memory_order_relaxed);
+        });
+    }
+    for (auto&& thread: threads)
+        thread.join();
+    res.aborts = aborts.load(::std::memory_order_relaxed);
+    return res;
+}
+
+/** Measurement of the epoch turnover on one region size and write fraction.
+**/
+struct EpochMeasure {
+    ::std::vector<double> commits; // Duration of the writer's 'tm_end' in each measured epoch (in ns)
+    ::std::vector<double> waits;   // Time from the writer's 'tm_end' call to the blocked waiter's 'tm_begin' return (in ns)
+    uint64_t unblocked;            // Measured epochs where the waiter's 'tm_begin' returned before the writer's 'tm_end' call
+    uint64_t aborts;               // Aborted transactions over all the epochs, warmup included
+};
+
+/** Drive epochs of one read-write transaction, committed while one read-only transaction waits to begin.
+ * @param tl        Transactional library to use
+ * @param align     Alignment (in bytes)
+ * @param size      Size of the first segment (in bytes)
+ * @param written   Number of bytes written by each epoch's read-write transaction, multiple of the alignment
+ * @param nbwarmups Number of unmeasured epochs
+ * @param nbepochs  Number of measured epochs
+ * @param delay     Time left to the waiter to block in its 'tm_begin' before the commit
+ * @return Measurement
+**/
+static EpochMeasure measure_epochs(TransactionalLibrary const& tl, size_t align, size_t size, size_t written, size_t nbwarmups, size_t nbepochs, ::std::chrono::microseconds delay) {
+    TransactionalMemory tm{tl, align, size};
+    EpochMeasure res{{}, {}, 0, 0};
+    ::std::unique_ptr<uint64_t[]> buf{new uint64_t[written / sizeof(uint64_t) + 1]()};
+    ::std::atomic<size_t> announced{0}; // Number of epochs whose read-write transaction is ready to commit
+    ::std::atomic<size_t> calling{0};   // Number of epochs whose waiter is about to call 'tm_begin'
+    ::std::atomic<size_t> done{0};      // Number of epochs whose waiter has committed
+    ::std::atomic<CycleChrono::Tick> commit_at{0};
+    ::std::atomic<uint64_t> waiter_aborts{0};
+    CycleChrono chrono;
+    chrono.start();
+    ::std::thread waiter{[&]() {
+        uint64_t aborts = 0;
+        for (size_t epoch = 1; epoch <= nbwarmups + nbepochs; ++epoch) {
+            while (announced.load(::std::memory_order_acquire) < epoch)
+                short_pause();
+            calling.store(epoch, ::std::memory_order_release);
+            aborts += commit(tm, true, [&](TransactionalMemory::TX) {
+                if (epoch > nbwarmups) {
+                    auto const now = chrono.delta();
+                    auto const from = commit_at.load(::std::memory_order_acquire);
+                    if (unlikely(from == 0 || now < from)) {
+                        ++res.unblocked;
+                    } else {
+                        res.waits.push_back(static_cast<double>(now - from));
+                    }
+                }
+                return true;
+            });
+            done.store(epoch, ::std::memory_order_release);
+        }
+        waiter_aborts.store(aborts, ::std::memory_order_relaxed);
+    }};
+    auto const span = size - written;
+    for (size_t epoch = 1; epoch <= nbwarmups + nbepochs; ++epoch) {
+        auto const offset = span > 0 ? (epoch * written) % span / align * align : 0;
+        auto const target = reinterpret_cast<char*>(tm.get_start()) + offset;
+        while (true) {
+            auto tx = tm.begin(false);
+            if (unlikely(tx == STM::invalid_tx)) {
+                ++res.aborts;
+                continue;
+            }
+            if (unlikely(written > 0 && !tm.write(tx, buf.get(), written, target))) {
+                ++res.aborts;
+                continue;
+            }
+            commit_at.store(0, ::std::memory_order_relaxed);
+            if (announced.load(::std::memory_order_relaxed) < epoch) {
+                announced.store(epoch, ::std::memory_order_release);
+                while (calling.load(::std::memory_order_acquire) < epoch)
+                    short_pause();
+                ::std::this_thread::sleep_for(delay);
+            }
+            auto const start = chrono.delta();
+            commit_at.store(start, ::std::memory_order_release);
+            auto const committed = tm.end(tx);
+            auto const duration = chrono.delta() - start;
+            if (likely(committed)) {
+                if (epoch > nbwarmups)
+                    res.commits.push_back(static_cast<double>(duration));
+                break;
+            }
+            ++res.aborts;
+        }
+        while (done.load(::std::memory_order_acquire) < epoch)
+            short_pause();
+    }
+    waiter.join();
+    res.aborts += waiter_aborts.load(::std::memory_order_relaxed);
+    return res;
+}
+
+/** Parse a size in bytes, optionally suffixed with 'K', 'M' or 'G' (powers of 1024).
+ * @param str String to parse
+ * @return Parsed size
+**/
+static size_t parse_size(::std::string const& str) {
+    size_t pos = 0;
+    unsigned long long res;
+    try {
+        res = ::std::stoull(str, &pos);
+    } catch (::std::exception const&) {
+        throw Exception::ArgumentValue{"invalid size"};
+    }
+    if (pos + 1 == str.size()) {
+        switch (str[pos]) {
+        case 'K': case 'k': res <<= 10; break;
+        case 'M': case 'm': res <<= 20; break;
+        case 'G': case 'g': res <<= 30; break;
+        default:
+            throw Exception::ArgumentValue{"invalid size suffix"};
+        }
+    } else if (unlikely(pos != str.size())) {
+        throw Exception::ArgumentValue{"invalid size"};
+    }
+    return static_cast<size_t>(res);
+}
+
+/** Format a size in bytes with the largest fitting binary unit.
+ * @param size Size to format (in bytes)
+ * @return Formatted size
+**/
+static ::std::string format_size(size_t size) {
+    char const* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    size_t unit = 0;
+    while (unit + 1 < sizeof(units) / sizeof(*units) && size >= 1024 && size % 1024 == 0) {
+        size /= 1024;
+        ++unit;
+    }
+    return ::std::to_string(size) + " " + units[unit];
+}
+
+/** Format the median, 90th percentile and maximum of a non-empty sample of durations.
+ * @param sample Sample of durations (in ns, copied, as sorted)
+ * @return Formatted summary (in µs)
+**/
+static ::std::string latencies(::std::vector<double> sample) {
+    ::std::sort(sample.begin(), sample.end());
+    ::std::ostringstream res;
+    res << (Stats::quantile(sample, .5) / 1000.) << " µs (p90 " << (Stats::quantile(sample, .9) / 1000.) << ", max " << (sample.back() / 1000.) << ")";
+    return res.str();
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Run the tm_* operation suite.
+ * @param args Parsed command line
+**/
+static void suite_ops(Arguments const& args) {
+    auto const max_threads = args.get<size_t>("threads", []() {
+        auto res = ::std::thread::hardware_concurrency();
+        if (unlikely(res == 0))
+            res = 16;
+        return static_cast<size_t>(res);
+    }());
+    auto const count     = args.get<size_t>("ops", 20000);
+    auto const nbwarmups = args.get<size_t>("warmup", 2);
+    auto const nbrepeats = args.get<size_t>("repeats", 7);
+    auto const align     = args.get<size_t>("align", 8);
+    auto const max_size  = args.get<size_t>("max-size", 4096);
+    auto const batch     = args.get<size_t>("batch", 16);
+    auto const only      = args.get<::std::string>("only", "");
+    args.check();
+    if (unlikely(max_threads == 0 || count == 0 || nbrepeats == 0 || batch == 0))
+        throw Exception::ArgumentValue{"at least one thread, operation, repetition and access per transaction are required"};
+    if (unlikely(align == 0 || (align & (align - 1)) != 0 || align % sizeof(void*) != 0 || max_size < align || max_size % align != 0))
+        throw Exception::ArgumentValue{"the alignment must be a power of 2 multiple of the pointer size, and the largest access size a multiple of it"};
+    ::std::vector<size_t> thread_counts;
+    for (size_t n = 1; n < max_threads; n *= 2)
+        thread_counts.push_back(n);
+    thread_counts.push_back(max_threads);
+    auto benches = microbenches(align, max_size, batch);
+    benches.erase(::std::remove_if(benches.begin(), benches.end(), [&](Microbench const& bench) { return bench.name.compare(0, only.size(), only) != 0; }), benches.end());
+    if (unlikely(benches.empty()))
+        throw Exception::ArgumentValue{"no benchmark matching the given prefix"};
+    // Print run parameters
+    ::std::cout << "⎧ #threads:            1 to " << max_threads << ::std::endl;
+    ::std::cout << "⎪ #operations:         " << count << " per thread and repetition" << ::std::endl;
+    ::std::cout << "⎪ #repetitions:        " << nbrepeats << " (after " << nbwarmups << " warmup)" << ::std::endl;
+    ::std::cout << "⎪ Alignment:           " << align << " B" << ::std::endl;
+    ::std::cout << "⎩ Accesses per TX:     " << batch << " (read and write benchmarks)" << ::std::endl;
+    // Run every benchmark of every library
+    for (size_t i = 0; i < args.size(); ++i) {
+        TransactionalLibrary const tl{args[i]};
+        ::std::cout << "⎧ Benchmarking '" << args[i] << "'..." << ::std::endl;
+        for (auto&& bench: benches) {
+            for (auto nbthreads: thread_counts) {
+                auto const res = measure(tl, bench, align, max_size, nbthreads, count, nbwarmups, nbrepeats);
+                auto const mean = Stats::mean(res.times) / static_cast<double>(count);
+                auto const sdev = Stats::stddev(res.times) / static_cast<double>(count);
+                ::std::cout << "⎪ " << bench.name << ::std::string(bench.name.size() < 16 ? 16 - bench.name.size() : 1, ' ') << nbthreads << " thread(s): "
+                    << mean << " ns/" << bench.unit << " ± " << sdev << " (median " << (Stats::median(res.times) / static_cast<double>(count)) << ", cv " << (mean > 0. ? sdev / mean * 100. : 0.) << " %), "
+                    << (static_cast<double>(nbthreads * count) / Stats::median(res.times) * 1000.) << " M " << bench.unit << "/s, "
+                    << res.aborts << " abort(s)" << ::std::endl;
+            }
+        }
+        ::std::cout << "⎩ Done" << ::std::endl;
+    }
+}
+
+/** Run the epoch turnover suite.
+ * @param args Parsed command line
+**/
+static void suite_epoch(Arguments const& args) {
+    auto const nbwarmups  = args.get<size_t>("warmup", 2);
+    auto const nbepochs   = args.get<size_t>("epochs", 20);
+    auto const align      = args.get<size_t>("align", 8);
+    auto const min_region = parse_size(args.get<::std::string>("min-region", "4K"));
+    auto const max_region = parse_size(args.get<::std::string>("max-region", "256M"));
+    auto const fractions_str = args.get<::std::string>("fractions", "0,0.01,0.1,1");
+    auto const delay      = ::std::chrono::microseconds{args.get<size_t>("delay", 100)};
+    args.check();
+    if (unlikely(nbepochs == 0))
+        throw Exception::ArgumentValue{"at least one epoch is required"};
+    if (unlikely(align == 0 || (align & (align - 1)) != 0 || align % sizeof(void*) != 0))
+        throw Exception::ArgumentValue{"the alignment must be a power of 2 multiple of the pointer size"};
+    if (unlikely(min_region < align || min_region % align != 0 || max_region < min_region))
+        throw Exception::ArgumentValue{"the region sizes must be multiples of the alignment, the smallest one not exceeding the largest one"};
+    ::std::vector<double> fractions;
+    {
+        ::std::istringstream stream{fractions_str};
+        ::std::string item;
+        while (::std::getline(stream, item, ',')) {
+            double fraction;
+            ::std::istringstream item_stream{item};
+            if (unlikely(!(item_stream >> fraction) || !item_stream.eof() || fraction < 0. || fraction > 1.))
+                throw Exception::ArgumentValue{"the written fractions must be numbers in [0, 1]"};
+            fractions.push_back(fraction);
+        }
+        if (unlikely(fractions.empty()))
+            throw Exception::ArgumentValue{"at least one written fraction is required"};
+    }
+    ::std::vector<size_t> regions;
+    for (auto region = min_region; region <= max_region; region *= 8) {
+        regions.push_back(region);
+        if (region > max_region / 8)
+            break;
+    }
+    // Print run parameters
+    ::std::cout << "⎧ Region sizes:        " << format_size(regions.front()) << " to " << format_size(regions.back()) << ", growing 8-fold" << ::std::endl;
+    ::std::cout << "⎪ Written fractions:   " << fractions_str << " of the region per epoch" << ::std::endl;
+    ::std::cout << "⎪ #epochs:             " << nbepochs << " (after " << nbwarmups << " warmup)" << ::std::endl;
+    ::std::cout << "⎪ Waiter delay:        " << delay.count() << " µs before each commit" << ::std::endl;
+    ::std::cout << "⎩ Alignment:           " << align << " B" << ::std::endl;
+    // Run every configuration of every library
+    for (size_t i = 0; i < args.size(); ++i) {
+        TransactionalLibrary const tl{args[i]};
+        ::std::cout << "⎧ Benchmarking '" << args[i] << "'..." << ::std::endl;
+        for (auto region: regions) {
+            for (auto fraction: fractions) {
+                auto const written = static_cast<size_t>(fraction * static_cast<double>(region)) / align * align;
+                auto const res = measure_epochs(tl, align, region, written, nbwarmups, nbepochs, delay);
+                ::std::ostringstream label;
+                label << format_size(region) << ", " << (fraction * 100.) << " %";
+                auto const label_str = label.str();
+                ::std::cout << "⎪ " << label_str << ::std::string(label_str.size() < 20 ? 20 - label_str.size() : 1, ' ')
+                    << "commit: " << latencies(res.commits) << ", " << (Stats::median(res.commits) / static_cast<double>(region)) << " ns/B; waiter: ";
+                if (res.waits.empty()) {
+                    ::std::cout << "never blocked";
+                } else {
+                    ::std::cout << latencies(res.waits);
+                    if (res.unblocked > 0)
+                        ::std::cout << ", " << res.unblocked << " epoch(s) not blocked";
+                }
+                ::std::cout << "; " << res.aborts << " abort(s)" << ::std::endl;
+            }
+        }
+        ::std::cout << "⎩ Done" << ::std::endl;
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Program entry point.
+ * @param argc Arguments count
+ * @param argv Arguments values
+ * @return Program return code
+**/
+int main(int argc, char** argv) {
+    try {
+        // Parse command line option(s)
+        Arguments const args{argc, argv};
+        if (args.size() < 1) {
+            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "microbench") << " [--option=value]... <library path>..." << ::std::endl;
+            ::std::cout << "Options:" << ::std::endl;
+            ::std::cout << "  --suite=<name>     Benchmark suite to run, 'ops' or 'epoch' (default: ops)" << ::std::endl;
+            ::std::cout << "  --warmup=<n>       Number of unmeasured repetitions (ops) or epochs (epoch) first (default: 2)" << ::std::endl;
+            ::std::cout << "  --align=<n>        Alignment, i.e. word size, in bytes (default: 8)" << ::std::endl;
+            ::std::cout << "Options of the 'ops' suite:" << ::std::endl;
+            ::std::cout << "  --threads=<n>      Maximum number of threads, run at 1, 2, 4... up to it (default: hardware concurrency)" << ::std::endl;
+            ::std::cout << "  --ops=<n>          Number of operations per thread and repetition (default: 20000)" << ::std::endl;
+            ::std::cout << "  --repeats=<n>      Number of measured repetitions (default: 7)" << ::std::endl;
+            ::std::cout << "  --max-size=<n>     Largest access size, in bytes, sizes growing 8-fold from one word (default: 4096)" << ::std::endl;
+            ::std::cout << "  --batch=<n>        Number of accesses per transaction in the read and write benchmarks (default: 16)" << ::std::endl;
+            ::std::cout << "  --only=<prefix>    Only run the benchmarks whose name starts with the given prefix" << ::std::endl;
+            ::std::cout << "Options of the 'epoch' suite:" << ::std::endl;
+            ::std::cout << "  --min-region=<n>   Smallest region size, in bytes, optionally suffixed with K, M or G (default: 4K)" << ::std::endl;
+            ::std::cout << "  --max-region=<n>   Largest region size, sizes growing 8-fold from the smallest one (default: 256M)" << ::std::endl;
+            ::std::cout << "  --fractions=<f,..> Fractions of the region written by each epoch's read-write TX (default: 0,0.01,0.1,1)" << ::std::endl;
+            ::std::cout << "  --epochs=<n>       Number of measured epochs per region size and fraction (default: 20)" << ::std::endl;
+            ::std::cout << "  --delay=<µs>       Time left to the waiter to block before each commit (default: 100)" << ::std::endl;
+            return 1;
+        }
+        auto const suite = args.get<::std::string>("suite", "ops");
+        if (suite == "ops") {
+            suite_ops(args);
+        } else if (suite == "epoch") {
+            suite_epoch(args);
+        } else {
+            throw Exception::ArgumentValue{"unknown benchmark suite"};
+        }
+        return 0;
+    } catch (::std::exception const& err) {
+        ::std::cerr << "⎧ *** EXCEPTION ***" << ::std::endl;
+        ::std::cerr << "⎩ " << err.what() << ::std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,150 @@
+/**
+ * @file   tm.c
+ * @author Will Yu (?@epfl.ch)
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Null transaction manager: no synchronization at all, reads and writes being plain copies.
+ * Only correct single-threaded; used by the grader to measure the cost of the workload and harness alone.
+**/
+
+// Requested feature: posix_memalign
+#define _POSIX_C_SOURCE   200809L
+
+// External headers
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal headers
+#include <tm.h>
+
+#include "macros.h"
+
+static const tx_t null_tx = UINTPTR_MAX - 10;
+
+/**
+ * @brief List of dynamically allocated segments.
+ */
+struct segment_node {
+    struct segment_node* prev;
+    struct segment_node* next;
+    // uint8_t segment[] // segment of dynamic size
+};
+typedef struct segment_node* segment_list;
+
+/**
+ * @brief Unsynchronized shared memory region.
+ */
+struct region {
+    void* start;         // Start of the shared memory region (i.e., of the non-deallocable memory segment)
+    segment_list allocs; // Shared memory segments dynamically allocated via tm_alloc
+    size_t size;         // Size of the non-deallocable memory segment (in bytes)
+    size_t align;        // Size of a word in the shared memory region (in bytes)
+};
+
+shared_t tm_create(size_t size, size_t align) {
+    struct region* region = (struct region*) malloc(sizeof(struct region));
+    if (unlikely(!region))
+        return invalid_shared;
+    if (posix_memalign(&(region->start), align, size) != 0) {
+        free(region);
+        return invalid_shared;
+    }
+    memset(region->start, 0, size);
+    region->allocs = NULL;
+    region->size   = size;
+    region->align  = align;
+    return region;
+}
+
+void tm_destroy(shared_t shared) {
+    struct region* region = (struct region*) shared;
+    while (region->allocs) {
+        segment_list tail = region->allocs->next;
+        free(region->allocs);
+        region->allocs = tail;
+    }
+    free(region->start);
+    free(region);
+}
+
+void* tm_start(shared_t shared) {
+    return ((struct region*) shared)->start;
+}
+
+size_t tm_size(shared_t shared) {
+    return ((struct region*) shared)->size;
+}
+
+size_t tm_align(shared_t shared) {
+    return ((struct region*) shared)->align;
+}
+
+tx_t tm_begin(shared_t unused(shared), bool unused(is_ro)) {
+    return null_tx;
+}
+
+bool tm_end(shared_t unused(shared), tx_t unused(tx)) {
+    return true;
+}
+
+bool tm_read(shared_t unused(shared), tx_t unused(tx), void const* source, size_t size, void* target) {
+    memcpy(target, source, size);
+    return true;
+}
+
+bool tm_write(shared_t unused(shared), tx_t unused(tx), void const* source, size_t size, void* target) {
+    memcpy(target, source, size);
+    return true;
+}
+
+alloc_t tm_alloc(shared_t shared, tx_t unused(tx), size_t size, void** target) {
+    // Same layout as the reference: the list node precedes the segment, aligned on max(align, pointer size)
+    size_t align = ((struct region*) shared)->align;
+    align = align < sizeof(struct segment_node*) ? sizeof(void*) : align;
+
+    struct segment_node* sn;
+    if (unlikely(posix_memalign((void**) &sn, align, sizeof(struct segment_node) + size) != 0))
+        return nomem_alloc;
+
+    sn->prev = NULL;
+    sn->next = ((struct region*) shared)->allocs;
+    if (sn->next)
+        sn->next->prev = sn;
+    ((struct region*) shared)->allocs = sn;
+
+    void* segment = (void*) ((uintptr_t) sn + sizeof(struct segment_node));
+    memset(segment, 0, size);
+    *target = segment;
+    return success_alloc;
+}
+
+bool tm_free(shared_t shared, tx_t unused(tx), void* segment) {
+    struct segment_node* sn = (struct segment_node*) ((uintptr_t) segment - sizeof(struct segment_node));
+
+    if (sn->prev) {
+        sn->prev->next = sn->next;
+    } else {
+        ((struct region*) shared)->allocs = sn->next;
+    }
+    if (sn->next)
+        sn->next->prev = sn->prev;
+    free(sn);
+    return true;
+}
@@ -0,0 +1,507 @@
+/**
+ * @file   tm.c
+ * @author Will Yu <?@epfl.ch>
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Profiling interposer: forwards every tm_* call to the implementation at path 'TM_PROFILE_LIBRARY',
+ * timing each call. Per-operation call counts and latency histograms, and per-transaction access
+ * counts and sizes, are printed when a shared memory region is destroyed, to the file at path
+ * 'TM_PROFILE_OUTPUT' (appended to) or to the standard error by default.
+**/
+
+// Requested features
+#define _GNU_SOURCE
+#define _POSIX_C_SOURCE   200809L
+
+// External headers
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Internal headers
+#include <tm.h>
+
+#include "macros.h"
+
+// -------------------------------------------------------------------------- //
+
+#define NBBUCKETS 65 // Number of histogram buckets, bucket i counting values in [2^(i-1), 2^i[ (bucket 0 counting 0)
+
+/** Profiled operation enum.
+**/
+enum op {
+    op_create,
+    op_destroy,
+    op_begin,
+    op_end,
+    op_read,
+    op_write,
+    op_alloc,
+    op_free,
+    nbops
+};
+
+static char const* const op_names[nbops] = { "tm_create", "tm_destroy", "tm_begin", "tm_end", "tm_read", "tm_write", "tm_alloc", "tm_free" };
+
+/** Per-transaction metric enum.
+**/
+enum metric {
+    metric_reads,   // Number of reads
+    metric_writes,  // Number of writes
+    metric_rbytes,  // Bytes read
+    metric_wbytes,  // Bytes written
+    metric_allocs,  // Number of allocations
+    metric_frees,   // Number of frees
+    nbmetrics
+};
+
+static char const* const metric_names[nbmetrics] = { "reads", "writes", "bytes read", "bytes written", "allocations", "frees" };
+
+/** Logarithmic histogram.
+**/
+struct histogram {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[NBBUCKETS];
+};
+
+/** Per-thread profile, registered once and kept for the whole process.
+**/
+struct profile {
+    struct profile*  next;                // Next registered profile
+    uint64_t         failed[nbops];       // Number of failed calls (invalid region/transaction, abort or refused allocation)
+    struct histogram latency[nbops];      // Call latency (in ns)
+    struct histogram rsize;               // Size of each read (in bytes)
+    struct histogram wsize;               // Size of each write (in bytes)
+    uint64_t         commits;             // Number of committed transactions
+    uint64_t         aborts;              // Number of aborted transactions
+    struct histogram committed[nbmetrics]; // Per-transaction metrics of the committed transactions
+    struct histogram aborted[nbmetrics];   // Per-transaction metrics of the aborted transactions
+    uint64_t         current[nbmetrics];  // Metrics of the running transaction
+};
+
+/** Implementation being profiled.
+**/
+static struct {
+    pthread_mutex_t lock; // Loading lock
+    char const* path;
+    void*    handle;
+    shared_t (*create)(size_t, size_t);
+    void     (*destroy)(shared_t);
+    void*    (*start)(shared_t);
+    size_t   (*size)(shared_t);
+    size_t   (*align)(shared_t);
+    tx_t     (*begin)(shared_t, bool);
+    bool     (*end)(shared_t, tx_t);
+    bool     (*read)(shared_t, tx_t, void const*, size_t, void*);
+    bool     (*write)(shared_t, tx_t, void const*, size_t, void*);
+    alloc_t  (*alloc)(shared_t, tx_t, size_t, void**);
+    bool     (*free)(shared_t, tx_t, void*);
+} library = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/** Registered per-thread profiles.
+**/
+static struct {
+    pthread_mutex_t lock;
+    struct profile* head;
+} profiles = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static _Thread_local struct profile* self = NULL; // Profile of the calling thread
+
+// -------------------------------------------------------------------------- //
+
+/** Load the profiled implementation, once.
+ * @return Whether the implementation is loaded
+**/
+static bool load_target() {
+    pthread_mutex_lock(&(library.lock));
+    if (library.handle) {
+        pthread_mutex_unlock(&(library.lock));
+        return true;
+    }
+    char const* path = getenv("TM_PROFILE_LIBRARY");
+    if (unlikely(!path)) {
+        fprintf(stderr, "profiler: 'TM_PROFILE_LIBRARY' must be set to the path of the library to profile\n");
+        pthread_mutex_unlock(&(library.lock));
+        return false;
+    }
+    void* handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (unlikely(!handle)) {
+        fprintf(stderr, "profiler: %s\n", dlerror());
+        pthread_mutex_unlock(&(library.lock));
+        return false;
+    }
+    #define LOAD(field, symbol) \
+        if (unlikely(!(*(void**) &(library.field) = dlsym(handle, symbol)))) { \
+            fprintf(stderr, "profiler: symbol '%s' not found in '%s'\n", symbol, path); \
+            dlclose(handle); \
+            pthread_mutex_unlock(&(library.lock)); \
+            return false; \
+        }
+    LOAD(create, "tm_create")
+    LOAD(destroy, "tm_destroy")
+    LOAD(start, "tm_start")
+    LOAD(size, "tm_size")
+    LOAD(align, "tm_align")
+    LOAD(begin, "tm_begin")
+    LOAD(end, "tm_end")
+    LOAD(read, "tm_read")
+    LOAD(write, "tm_write")
+    LOAD(alloc, "tm_alloc")
+    LOAD(free, "tm_free")
+    #undef LOAD
+    library.path   = path;
+    library.handle = handle;
+    pthread_mutex_unlock(&(library.lock));
+    return true;
+}
+
+/** Read the monotonic clock.
+ * @return Current time (in ns)
+**/
+static inline uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ul + (uint64_t) ts.tv_nsec;
+}
+
+/** Get the profile of the calling thread, registering it on first use.
+ * @return Thread profile, 'NULL' if it could not be allocated
+**/
+static struct profile* get_self() {
+    if (likely(self))
+        return self;
+    struct profile* prof = (struct profile*) calloc(1, sizeof(struct profile));
+    if (unlikely(!prof))
+        return NULL;
+    pthread_mutex_lock(&(profiles.lock));
+    prof->next = profiles.head;
+    profiles.head = prof;
+    pthread_mutex_unlock(&(profiles.lock));
+    self = prof;
+    return prof;
+}
+
+/** Add a value to a histogram.
+ * @param hist  Histogram
+ * @param value Value to add
+**/
+static inline void hist_add(struct histogram* hist, uint64_t value) {
+    ++hist->count;
+    hist->sum += value;
+    if (value > hist->max)
+        hist->max = value;
+    ++hist->buckets[value == 0 ? 0 : 64 - __builtin_clzll(value)];
+}
+
+/** Merge a histogram into another.
+ * @param into Merged-into histogram
+ * @param from Merged histogram
+**/
+static void hist_merge(struct histogram* into, struct histogram const* from) {
+    into->count += from->count;
+    into->sum   += from->sum;
+    if (from->max > into->max)
+        into->max = from->max;
+    for (size_t i = 0; i < NBBUCKETS; ++i)
+        into->buckets[i] += from->buckets[i];
+}
+
+/** Get an upper bound of the given quantile of a histogram.
+ * @param hist  Non-empty histogram
+ * @param level Quantile level in [0, 1]
+ * @return Upper bound of the bucket holding the quantile, capped by the maximum
+**/
+static uint64_t hist_quantile(struct histogram const* hist, double level) {
+    uint64_t rank = (uint64_t) (level * (double) (hist->count - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NBBUCKETS; ++i) {
+        seen += hist->buckets[i];
+        if (seen > rank) {
+            uint64_t bound = i == 0 ? 0 : (i == 64 ? UINT64_MAX : (UINT64_C(1) << i) - 1);
+            return bound < hist->max ? bound : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+/** Print one histogram line.
+ * @param out   Output stream
+ * @param label Line label
+ * @param hist  Histogram
+**/
+static void hist_print(FILE* out, char const* label, struct histogram const* hist) {
+    if (hist->count == 0) {
+        fprintf(out, "⎪ %-13s %12s\n", label, "-");
+        return;
+    }
+    fprintf(out, "⎪ %-13s %12lu %12.1f %10lu %10lu %10lu %12lu\n", label, (unsigned long) hist->count, (double) hist->sum / (double) hist->count,
+        (unsigned long) hist_quantile(hist, 0.5), (unsigned long) hist_quantile(hist, 0.9), (unsigned long) hist_quantile(hist, 0.99), (unsigned long) hist->max);
+}
+
+/** Finish the running transaction of the calling thread.
+ * @param prof      Thread profile
+ * @param committed Whether the transaction committed
+**/
+static void tx_finish(struct profile* prof, bool committed) {
+    struct histogram* hists = committed ? prof->committed : prof->aborted;
+    if (committed) {
+        ++prof->commits;
+    } else {
+        ++prof->aborts;
+    }
+    for (size_t i = 0; i < nbmetrics; ++i) {
+        hist_add(&(hists[i]), prof->current[i]);
+        prof->current[i] = 0;
+    }
+}
+
+/** Merge, print then reset every thread's profile, no transaction running.
+**/
+static void dump() {
+    struct profile total;
+    memset(&total, 0, sizeof(struct profile));
+    pthread_mutex_lock(&(profiles.lock));
+    for (struct profile* prof = profiles.head; prof; prof = prof->next) {
+        for (size_t i = 0; i < nbops; ++i) {
+            total.failed[i] += prof->failed[i];
+            hist_merge(&(total.latency[i]), &(prof->latency[i]));
+        }
+        hist_merge(&(total.rsize), &(prof->rsize));
+        hist_merge(&(total.wsize), &(prof->wsize));
+        total.commits += prof->commits;
+        total.aborts  += prof->aborts;
+        for (size_t i = 0; i < nbmetrics; ++i) {
+            hist_merge(&(total.committed[i]), &(prof->committed[i]));
+            hist_merge(&(total.aborted[i]), &(prof->aborted[i]));
+        }
+        struct profile* next = prof->next;
+        memset(prof, 0, sizeof(struct profile));
+        prof->next = next;
+    }
+    pthread_mutex_unlock(&(profiles.lock));
+    char const* path = getenv("TM_PROFILE_OUTPUT");
+    FILE* out = path ? fopen(path, "a") : stderr;
+    if (unlikely(!out)) {
+        fprintf(stderr, "profiler: unable to open output file '%s'\n", path);
+        out = stderr;
+    }
+    fprintf(out, "⎧ Profile of '%s'\n", library.path);
+    fprintf(out, "⎪ %-13s %12s %12s %10s %10s %10s %12s %12s\n", "Latency (ns)", "calls", "mean", "p50", "p90", "p99", "max", "failed");
+    for (size_t i = 0; i < nbops; ++i) {
+        struct histogram const* hist = &(total.latency[i]);
+        if (hist->count == 0)
+            continue;
+        fprintf(out, "⎪ %-13s %12lu %12.1f %10lu %10lu %10lu %12lu %12lu\n", op_names[i], (unsigned long) hist->count, (double) hist->sum / (double) hist->count,
+            (unsigned long) hist_quantile(hist, 0.5), (unsigned long) hist_quantile(hist, 0.9), (unsigned long) hist_quantile(hist, 0.99), (unsigned long) hist->max, (unsigned long) total.failed[i]);
+    }
+    fprintf(out, "⎪ %-13s %12s %12s %10s %10s %10s %12s\n", "Size (B)", "accesses", "mean", "p50", "p90", "p99", "max");
+    hist_print(out, "tm_read", &(total.rsize));
+    hist_print(out, "tm_write", &(total.wsize));
+    fprintf(out, "⎪ Transactions: %lu committed, %lu aborted (%.2f %%)\n", (unsigned long) total.commits, (unsigned long) total.aborts,
+        total.commits + total.aborts > 0 ? 100. * (double) total.aborts / (double) (total.commits + total.aborts) : 0.);
+    fprintf(out, "⎪ %-13s %12s %12s %10s %10s %10s %12s\n", "Per commit", "TX", "mean", "p50", "p90", "p99", "max");
+    for (size_t i = 0; i < nbmetrics; ++i)
+        hist_print(out, metric_names[i], &(total.committed[i]));
+    if (total.aborts > 0) {
+        fprintf(out, "⎪ %-13s %12s %12s %10s %10s %10s %12s\n", "Per abort", "TX", "mean", "p50", "p90", "p99", "max");
+        for (size_t i = 0; i < nbmetrics; ++i)
+            hist_print(out, metric_names[i], &(total.aborted[i]));
+    }
+    fprintf(out, "⎩ (quantiles are upper bounds of power-of-2 buckets)\n");
+    if (out != stderr)
+        fclose(out);
+}
+
+/** Record the latency of a call.
+ * @param op    Operation
+ * @param start Start time of the call (in ns)
+ * @param ok    Whether the call succeeded
+ * @return Profile of the calling thread, 'NULL' if unavailable
+**/
+static inline struct profile* account(enum op op, uint64_t start, bool ok) {
+    uint64_t end = now();
+    struct profile* prof = get_self();
+    if (unlikely(!prof))
+        return NULL;
+    hist_add(&(prof->latency[op]), end - start);
+    if (unlikely(!ok))
+        ++prof->failed[op];
+    return prof;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
+ * @param size  Size of the first shared segment of memory to allocate (in bytes), must be a positive multiple of the alignment
+ * @param align Alignment (in bytes, must be a power of 2) that the shared memory region must support
+ * @return Opaque shared memory region handle, 'invalid_shared' on failure
+**/
+shared_t tm_create(size_t size, size_t align) {
+    if (unlikely(!load_target()))
+        return invalid_shared;
+    uint64_t start = now();
+    shared_t res = library.create(size, align);
+    account(op_create, start, res != invalid_shared);
+    return res;
+}
+
+/** Destroy (i.e. clean-up + free) a given shared memory region, then print and reset the profile.
+ * @param shared Shared memory region to destroy, with no running transaction
+**/
+void tm_destroy(shared_t shared) {
+    uint64_t start = now();
+    library.destroy(shared);
+    account(op_destroy, start, true);
+    dump();
+}
+
+/** [thread-safe] Return the start address of the first allocated segment in the shared memory region.
+ * @param shared Shared memory region to query
+ * @return Start address of the first allocated segment
+**/
+void* tm_start(shared_t shared) {
+    return library.start(shared);
+}
+
+/** [thread-safe] Return the size (in bytes) of the first allocated segment of the shared memory region.
+ * @param shared Shared memory region to query
+ * @return First allocated segment size
+**/
+size_t tm_size(shared_t shared) {
+    return library.size(shared);
+}
+
+/** [thread-safe] Return the alignment (in bytes) of the memory accesses on the given shared memory region.
+ * @param shared Shared memory region to query
+ * @return Alignment used globally
+**/
+size_t tm_align(shared_t shared) {
+    return library.align(shared);
+}
+
+/** [thread-safe] Begin a new transaction on the given shared memory region.
+ * @param shared Shared memory region to start a transaction on
+ * @param is_ro  Whether the transaction is read-only
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+tx_t tm_begin(shared_t shared, bool is_ro) {
+    uint64_t start = now();
+    tx_t res = library.begin(shared, is_ro);
+    account(op_begin, start, res != invalid_tx);
+    return res;
+}
+
+/** [thread-safe] End the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to end
+ * @return Whether the whole transaction committed
+**/
+bool tm_end(shared_t shared, tx_t tx) {
+    uint64_t start = now();
+    bool res = library.end(shared, tx);
+    struct profile* prof = account(op_end, start, res);
+    if (likely(prof))
+        tx_finish(prof, res);
+    return res;
+}
+
+/** [thread-safe] Read operation in the given transaction, source in the shared region and target in a private region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in the shared region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in a private region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    uint64_t start = now();
+    bool res = library.read(shared, tx, source, size, target);
+    struct profile* prof = account(op_read, start, res);
+    if (likely(prof)) {
+        hist_add(&(prof->rsize), size);
+        ++prof->current[metric_reads];
+        prof->current[metric_rbytes] += size;
+        if (!res)
+            tx_finish(prof, false);
+    }
+    return res;
+}
+
+/** [thread-safe] Write operation in the given transaction, source in a private region and target in the shared region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in a private region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in the shared region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    uint64_t start = now();
+    bool res = library.write(shared, tx, source, size, target);
+    struct profile* prof = account(op_write, start, res);
+    if (likely(prof)) {
+        hist_add(&(prof->wsize), size);
+        ++prof->current[metric_writes];
+        prof->current[metric_wbytes] += size;
+        if (!res)
+            tx_finish(prof, false);
+    }
+    return res;
+}
+
+/** [thread-safe] Memory allocation in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param size   Allocation requested size (in bytes), must be a positive multiple of the alignment
+ * @param target Pointer in private memory receiving the address of the first byte of the newly allocated, aligned segment
+ * @return Whether the whole transaction can continue (success/nomem), or not (abort_alloc)
+**/
+alloc_t tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) {
+    uint64_t start = now();
+    alloc_t res = library.alloc(shared, tx, size, target);
+    struct profile* prof = account(op_alloc, start, res == success_alloc);
+    if (likely(prof)) {
+        ++prof->current[metric_allocs];
+        if (res == abort_alloc)
+            tx_finish(prof, false);
+    }
+    return res;
+}
+
+/** [thread-safe] Memory freeing in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param target Address of the first byte of the previously allocated segment to deallocate
+ * @return Whether the whole transaction can continue
+**/
+bool tm_free(shared_t shared, tx_t tx, void* target) {
+    uint64_t start = now();
+    bool res = library.free(shared, tx, target);
+    struct profile* prof = account(op_free, start, res);
+    if (likely(prof)) {
+        ++prof->current[metric_frees];
+        if (!res)
+            tx_finish(prof, false);
+    }
+    return res;
+}
@@ -0,0 +1,568 @@
+/**
+ * @file   tm.c
+ * @author Will Yu <?@epfl.ch>
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2023 Yue Yu.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Recording interposer: forwards every tm_* call to the implementation at path 'TM_RECORD_LIBRARY',
+ * and writes the calls made on the first shared memory region created by the process to the binary trace
+ * file at path 'TM_RECORD_TRACE' (default: "tm.trace"), in the format of 'trace.h'. The trace is complete
+ * once the region is destroyed; the regions created afterwards are only forwarded, so that they cannot
+ * overwrite it. At most 65536 threads are recorded, the calls of any later thread being forwarded only.
+**/
+
+// Requested features
+#define _GNU_SOURCE
+#define _POSIX_C_SOURCE   200809L
+#ifdef __STDC_NO_ATOMICS__
+    #error Current C11 compiler does not support atomic operations
+#endif
+
+// External headers
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Internal headers
+#include <tm.h>
+#include <trace.h>
+
+#include "macros.h"
+
+// -------------------------------------------------------------------------- //
+
+#define BUFFER_SIZE 4096 // Number of records buffered per thread before being written
+#define MAX_THREADS (UINT16_MAX + 1) // Number of distinct thread IDs in a trace
+
+/** Implementation being recorded.
+**/
+static struct {
+    pthread_mutex_t lock; // Loading lock
+    void*    handle;
+    shared_t (*create)(size_t, size_t);
+    void     (*destroy)(shared_t);
+    void*    (*start)(shared_t);
+    size_t   (*size)(shared_t);
+    size_t   (*align)(shared_t);
+    tx_t     (*begin)(shared_t, bool);
+    bool     (*end)(shared_t, tx_t);
+    bool     (*read)(shared_t, tx_t, void const*, size_t, void*);
+    bool     (*write)(shared_t, tx_t, void const*, size_t, void*);
+    alloc_t  (*alloc)(shared_t, tx_t, size_t, void**);
+    bool     (*free)(shared_t, tx_t, void*);
+} library = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/** Live segment of the recorded region.
+**/
+struct segment {
+    uintptr_t base; // Opaque start address
+    size_t    size; // Size (in bytes)
+    uint32_t  id;   // Segment ID in the trace
+};
+
+/** Growable list of segment start addresses, used for the uncommitted allocations and frees of a transaction.
+**/
+struct pending {
+    uintptr_t* bases;
+    size_t     count;
+    size_t     capacity;
+};
+
+/** Per-thread recording state, registered once and kept for the whole process.
+**/
+struct thread_state {
+    struct thread_state*   next;   // Next registered state
+    uint16_t               id;     // Thread ID in the trace
+    size_t                 count;  // Number of buffered records
+    struct pending         allocs; // Segments allocated by the current transaction
+    struct pending         frees;  // Segments freed by the current transaction
+    struct tm_trace_record buffer[BUFFER_SIZE];
+};
+
+/** Recording of the traced region.
+**/
+static struct {
+    shared_t                shared;     // Recorded region, 'invalid_shared' if none
+    bool                    done;       // Whether a region has been recorded and destroyed, no other one being recorded
+    FILE*                   file;       // Trace file
+    pthread_mutex_t         file_lock;  // Trace file (and header) lock
+    struct tm_trace_header  header;     // Header, completed when the region is destroyed
+    struct timespec         origin;     // Creation time of the region
+    atomic_uint_fast32_t    nbsegments; // Number of segment IDs taken
+    pthread_rwlock_t        seg_lock;   // Segment table lock
+    struct segment*         segments;   // Live segments, sorted by start address
+    size_t                  seg_count;
+    size_t                  seg_capacity;
+    pthread_mutex_t         reg_lock;   // Thread registry lock
+    struct thread_state*    threads;    // Registered thread states
+    uint32_t                nbthreads;  // Number of registered threads, at most 'MAX_THREADS'
+    uint32_t                nbignored;  // Number of threads not registered, beyond 'MAX_THREADS'
+} recording = {
+    .shared    = invalid_shared,
+    .file_lock = PTHREAD_MUTEX_INITIALIZER,
+    .seg_lock  = PTHREAD_RWLOCK_INITIALIZER,
+    .reg_lock  = PTHREAD_MUTEX_INITIALIZER
+};
+
+static _Thread_local struct thread_state* self = NULL; // Recording state of the calling thread
+static _Thread_local bool ignored = false; // Whether the calling thread is not recorded, the thread IDs being exhausted
+
+// -------------------------------------------------------------------------- //
+
+/** Load the recorded implementation, once.
+ * @return Whether the implementation is loaded
+**/
+static bool load_target() {
+    pthread_mutex_lock(&(library.lock));
+    if (library.handle) {
+        pthread_mutex_unlock(&(library.lock));
+        return true;
+    }
+    char const* path = getenv("TM_RECORD_LIBRARY");
+    if (unlikely(!path)) {
+        fprintf(stderr, "recorder: 'TM_RECORD_LIBRARY' must be set to the path of the library to record\n");
+        pthread_mutex_unlock(&(library.lock));
+        return false;
+    }
+    void* handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (unlikely(!handle)) {
+        fprintf(stderr, "recorder: %s\n", dlerror());
+        pthread_mutex_unlock(&(library.lock));
+        return false;
+    }
+    #define LOAD(field, symbol) \
+        if (unlikely(!(*(void**) &(library.field) = dlsym(handle, symbol)))) { \
+            fprintf(stderr, "recorder: symbol '%s' not found in '%s'\n", symbol, path); \
+            dlclose(handle); \
+            pthread_mutex_unlock(&(library.lock)); \
+            return false; \
+        }
+    LOAD(create, "tm_create")
+    LOAD(destroy, "tm_destroy")
+    LOAD(start, "tm_start")
+    LOAD(size, "tm_size")
+    LOAD(align, "tm_align")
+    LOAD(begin, "tm_begin")
+    LOAD(end, "tm_end")
+    LOAD(read, "tm_read")
+    LOAD(write, "tm_write")
+    LOAD(alloc, "tm_alloc")
+    LOAD(free, "tm_free")
+    #undef LOAD
+    library.handle = handle;
+    pthread_mutex_unlock(&(library.lock));
+    return true;
+}
+
+/** Get the time elapsed since the creation of the recorded region.
+ * @return Elapsed time (in ns)
+**/
+static uint64_t elapsed() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) (now.tv_sec - recording.origin.tv_sec) * 1000000000ul + (uint64_t) now.tv_nsec - (uint64_t) recording.origin.tv_nsec;
+}
+
+/** Write the buffered records of a thread to the trace file, and empty its buffer.
+ * @param state Thread state to flush
+**/
+static void flush(struct thread_state* state) {
+    if (state->count == 0)
+        return;
+    pthread_mutex_lock(&(recording.file_lock));
+    if (recording.file && fwrite(state->buffer, sizeof(struct tm_trace_record), state->count, recording.file) == state->count)
+        recording.header.nbrecords += state->count;
+    pthread_mutex_unlock(&(recording.file_lock));
+    state->count = 0;
+}
+
+/** Get the recording state of the calling thread, registering it on first use.
+ * @return Thread state, 'NULL' if it could not be allocated or the thread IDs are exhausted
+**/
+static struct thread_state* get_self() {
+    if (likely(self))
+        return self;
+    if (unlikely(ignored))
+        return NULL;
+    struct thread_state* state = (struct thread_state*) calloc(1, sizeof(struct thread_state));
+    if (unlikely(!state))
+        return NULL;
+    pthread_mutex_lock(&(recording.reg_lock));
+    if (unlikely(recording.nbthreads == MAX_THREADS)) {
+        ++recording.nbignored;
+        pthread_mutex_unlock(&(recording.reg_lock));
+        free(state);
+        ignored = true;
+        return NULL;
+    }
+    state->id   = (uint16_t) recording.nbthreads++;
+    state->next = recording.threads;
+    recording.threads = state;
+    pthread_mutex_unlock(&(recording.reg_lock));
+    self = state;
+    return state;
+}
+
+/** Append a record to the calling thread's buffer.
+ * @param op      Operation
+ * @param flags   Combination of 'TM_TRACE_*' flags
+ * @param segment Segment ID
+ * @param offset  Offset in the segment (in bytes)
+ * @param size    Accessed or allocated size (in bytes)
+**/
+static void record(enum tm_trace_op op, uint8_t flags, uint32_t segment, uint64_t offset, uint64_t size) {
+    struct thread_state* state = get_self();
+    if (unlikely(!state))
+        return;
+    struct tm_trace_record* rec = &(state->buffer[state->count]);
+    rec->time    = elapsed();
+    rec->offset  = offset;
+    rec->size    = size;
+    rec->segment = segment;
+    rec->thread  = state->id;
+    rec->op      = (uint8_t) op;
+    rec->flags   = flags;
+    if (unlikely(++state->count == BUFFER_SIZE))
+        flush(state);
+}
+
+/** Find the position of the first live segment starting at or after an address, the segment table being locked.
+ * @param base Start address
+ * @return Position in the segment table
+**/
+static size_t seg_position(uintptr_t base) {
+    size_t low = 0;
+    size_t high = recording.seg_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (recording.segments[mid].base < base) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/** Add a live segment to the table, replacing any segment with the same start address.
+ * @param base Opaque start address
+ * @param size Size (in bytes)
+ * @param id   Segment ID
+ * @return Whether the segment could be added
+**/
+static bool seg_insert(uintptr_t base, size_t size, uint32_t id) {
+    pthread_rwlock_wrlock(&(recording.seg_lock));
+    size_t pos = seg_position(base);
+    if (pos == recording.seg_count || recording.segments[pos].base != base) {
+        if (recording.seg_count == recording.seg_capacity) {
+            size_t capacity = recording.seg_capacity > 0 ? 2 * recording.seg_capacity : 64;
+            struct segment* segments = (struct segment*) realloc(recording.segments, capacity * sizeof(struct segment));
+            if (unlikely(!segments)) {
+                pthread_rwlock_unlock(&(recording.seg_lock));
+                return false;
+            }
+            recording.segments     = segments;
+            recording.seg_capacity = capacity;
+        }
+        memmove(recording.segments + pos + 1, recording.segments + pos, (recording.seg_count - pos) * sizeof(struct segment));
+        ++recording.seg_count;
+    }
+    recording.segments[pos] = (struct segment) { .base = base, .size = size, .id = id };
+    pthread_rwlock_unlock(&(recording.seg_lock));
+    return true;
+}
+
+/** Remove a live segment from the table, if present.
+ * @param base Opaque start address
+**/
+static void seg_remove(uintptr_t base) {
+    pthread_rwlock_wrlock(&(recording.seg_lock));
+    size_t pos = seg_position(base);
+    if (pos < recording.seg_count && recording.segments[pos].base == base) {
+        memmove(recording.segments + pos, recording.segments + pos + 1, (recording.seg_count - pos - 1) * sizeof(struct segment));
+        --recording.seg_count;
+    }
+    pthread_rwlock_unlock(&(recording.seg_lock));
+}
+
+/** Translate an opaque shared address into a segment ID and offset.
+ * @param addr   Opaque address
+ * @param offset Offset in the segment (in bytes, output)
+ * @return Segment ID, 'TM_TRACE_NO_SEGMENT' if in no live segment
+**/
+static uint32_t seg_lookup(void const* addr, uint64_t* offset) {
+    uintptr_t const where = (uintptr_t) addr;
+    uint32_t id = TM_TRACE_NO_SEGMENT;
+    *offset = 0;
+    pthread_rwlock_rdlock(&(recording.seg_lock));
+    size_t pos = seg_position(where + 1); // First segment starting after 'where'
+    if (pos > 0) {
+        struct segment const* seg = &(recording.segments[pos - 1]);
+        if (where - seg->base < seg->size) {
+            id = seg->id;
+            *offset = where - seg->base;
+        }
+    }
+    pthread_rwlock_unlock(&(recording.seg_lock));
+    return id;
+}
+
+/** Append a start address to a pending list (silently dropped if out of memory).
+ * @param list Pending list
+ * @param base Start address
+**/
+static void pending_push(struct pending* list, uintptr_t base) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity > 0 ? 2 * list->capacity : 16;
+        uintptr_t* bases = (uintptr_t*) realloc(list->bases, capacity * sizeof(uintptr_t));
+        if (unlikely(!bases))
+            return;
+        list->bases    = bases;
+        list->capacity = capacity;
+    }
+    list->bases[list->count++] = base;
+}
+
+/** Settle the segment table at the end of the calling thread's transaction.
+ * @param committed Whether the transaction committed (frees take effect) or aborted (allocations are undone)
+**/
+static void settle(bool committed) {
+    struct thread_state* state = get_self();
+    if (unlikely(!state))
+        return;
+    struct pending* undone = committed ? &(state->frees) : &(state->allocs);
+    for (size_t i = 0; i < undone->count; ++i)
+        seg_remove(undone->bases[i]);
+    state->allocs.count = 0;
+    state->frees.count  = 0;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
+ * Only the first region of the process is recorded, the other ones are merely forwarded.
+ * @param size  Size of the first shared segment of memory to allocate (in bytes), must be a positive multiple of the alignment
+ * @param align Alignment (in bytes, must be a power of 2) that the shared memory region must support
+ * @return Opaque shared memory region handle, 'invalid_shared' on failure
+**/
+shared_t tm_create(size_t size, size_t align) {
+    if (unlikely(!load_target()))
+        return invalid_shared;
+    shared_t shared = library.create(size, align);
+    if (unlikely(shared == invalid_shared))
+        return invalid_shared;
+    pthread_mutex_lock(&(recording.file_lock));
+    if (recording.shared != invalid_shared || recording.done) { // Recording or recorded another region
+        pthread_mutex_unlock(&(recording.file_lock));
+        return shared;
+    }
+    char const* path = getenv("TM_RECORD_TRACE");
+    recording.file = fopen(path ? path : "tm.trace", "wb");
+    if (unlikely(!recording.file)) {
+        fprintf(stderr, "recorder: unable to open trace file '%s'\n", path ? path : "tm.trace");
+        pthread_mutex_unlock(&(recording.file_lock));
+        return shared;
+    }
+    memset(&(recording.header), 0, sizeof(struct tm_trace_header));
+    strcpy(recording.header.magic, TM_TRACE_MAGIC);
+    recording.header.version = TM_TRACE_VERSION;
+    recording.header.size    = size;
+    recording.header.align   = align;
+    fwrite(&(recording.header), sizeof(struct tm_trace_header), 1, recording.file); // Completed on destruction
+    clock_gettime(CLOCK_MONOTONIC, &(recording.origin));
+    atomic_store(&(recording.nbsegments), 1);
+    recording.seg_count = 0;
+    recording.shared = shared;
+    pthread_mutex_unlock(&(recording.file_lock));
+    seg_insert((uintptr_t) library.start(shared), size, 0);
+    return shared;
+}
+
+/** Destroy (i.e. clean-up + free) a given shared memory region, completing its trace if recorded.
+ * @param shared Shared memory region to destroy, with no running transaction
+**/
+void tm_destroy(shared_t shared) {
+    if (shared == recording.shared) {
+        pthread_mutex_lock(&(recording.reg_lock));
+        for (struct thread_state* state = recording.threads; state; state = state->next) {
+            flush(state);
+            state->allocs.count = 0;
+            state->frees.count  = 0;
+        }
+        uint32_t nbthreads = recording.nbthreads;
+        uint32_t nbignored = recording.nbignored;
+        pthread_mutex_unlock(&(recording.reg_lock));
+        if (unlikely(nbignored > 0))
+            fprintf(stderr, "recorder: %u thread(s) not recorded, beyond the %u thread IDs of a trace\n", (unsigned int) nbignored, (unsigned int) MAX_THREADS);
+        pthread_mutex_lock(&(recording.file_lock));
+        recording.header.nbthreads  = nbthreads;
+        recording.header.nbsegments = atomic_load(&(recording.nbsegments));
+        if (likely(recording.file)) {
+            if (unlikely(fseek(recording.file, 0, SEEK_SET) != 0 || fwrite(&(recording.header), sizeof(struct tm_trace_header), 1, recording.file) != 1))
+                fprintf(stderr, "recorder: unable to complete the trace file\n");
+            fclose(recording.file);
+            recording.file = NULL;
+        }
+        recording.shared = invalid_shared;
+        recording.done   = true;
+        pthread_mutex_unlock(&(recording.file_lock));
+    }
+    library.destroy(shared);
+}
+
+/** [thread-safe] Return the start address of the first allocated segment in the shared memory region.
+ * @param shared Shared memory region to query
+ * @return Start address of the first allocated segment
+**/
+void* tm_start(shared_t shared) {
+    return library.start(shared);
+}
+
+/** [thread-safe] Return the size (in bytes) of the first allocated segment of the shared memory region.
+ * @param shared Shared memory region to query
+ * @return First allocated segment size
+**/
+size_t tm_size(shared_t shared) {
+    return library.size(shared);
+}
+
+/** [thread-safe] Return the alignment (in bytes) of the memory accesses on the given shared memory region.
+ * @param shared Shared memory region to query
+ * @return Alignment used globally
+**/
+size_t tm_align(shared_t shared) {
+    return library.align(shared);
+}
+
+/** [thread-safe] Begin a new transaction on the given shared memory region.
+ * @param shared Shared memory region to start a transaction on
+ * @param is_ro  Whether the transaction is read-only
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+tx_t tm_begin(shared_t shared, bool is_ro) {
+    tx_t tx = library.begin(shared, is_ro);
+    if (shared == recording.shared)
+        record(tm_trace_begin, (tx != invalid_tx ? TM_TRACE_SUCCESS : 0) | (is_ro ? TM_TRACE_RO : 0), TM_TRACE_NO_SEGMENT, 0, 0);
+    return tx;
+}
+
+/** [thread-safe] End the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to end
+ * @return Whether the whole transaction committed
+**/
+bool tm_end(shared_t shared, tx_t tx) {
+    bool res = library.end(shared, tx);
+    if (shared == recording.shared) {
+        record(tm_trace_end, res ? TM_TRACE_SUCCESS : 0, TM_TRACE_NO_SEGMENT, 0, 0);
+        settle(res);
+    }
+    return res;
+}
+
+/** [thread-safe] Read operation in the given transaction, source in the shared region and target in a private region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in the shared region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in a private region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    bool res = library.read(shared, tx, source, size, target);
+    if (shared == recording.shared) {
+        uint64_t offset;
+        uint32_t segment = seg_lookup(source, &offset);
+        record(tm_trace_read, res ? TM_TRACE_SUCCESS : 0, segment, offset, size);
+        if (!res)
+            settle(false);
+    }
+    return res;
+}
+
+/** [thread-safe] Write operation in the given transaction, source in a private region and target in the shared region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in a private region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in the shared region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    bool res = library.write(shared, tx, source, size, target);
+    if (shared == recording.shared) {
+        uint64_t offset;
+        uint32_t segment = seg_lookup(target, &offset);
+        record(tm_trace_write, res ? TM_TRACE_SUCCESS : 0, segment, offset, size);
+        if (!res)
+            settle(false);
+    }
+    return res;
+}
+
+/** [thread-safe] Memory allocation in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param size   Allocation requested size (in bytes), must be a positive multiple of the alignment
+ * @param target Pointer in private memory receiving the address of the first byte of the newly allocated, aligned segment
+ * @return Whether the whole transaction can continue (success/nomem), or not (abort_alloc)
+**/
+alloc_t tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) {
+    alloc_t res = library.alloc(shared, tx, size, target);
+    if (shared == recording.shared) {
+        if (res == success_alloc) {
+            uint32_t segment = (uint32_t) atomic_fetch_add(&(recording.nbsegments), 1);
+            if (likely(seg_insert((uintptr_t) *target, size, segment))) {
+                struct thread_state* state = get_self();
+                if (likely(state))
+                    pending_push(&(state->allocs), (uintptr_t) *target);
+            }
+            record(tm_trace_alloc, TM_TRACE_SUCCESS, segment, 0, size);
+        } else if (res == abort_alloc) {
+            record(tm_trace_alloc, 0, TM_TRACE_NO_SEGMENT, 0, size);
+            settle(false);
+        } // Refused allocations do not change the transaction, and are not recorded
+    }
+    return res;
+}
+
+/** [thread-safe] Memory freeing in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param target Address of the first byte of the previously allocated segment to deallocate
+ * @return Whether the whole transaction can continue
+**/
+bool tm_free(shared_t shared, tx_t tx, void* target) {
+    bool res = library.free(shared, tx, target);
+    if (shared == recording.shared) {
+        uint64_t offset;
+        uint32_t segment = seg_lookup(target, &offset);
+        record(tm_trace_free, res ? TM_TRACE_SUCCESS : 0, segment, 0, 0);
+        if (res) {
+            struct thread_state* state = get_self();
+            if (likely(state))
+                pending_push(&(state->frees), (uintptr_t) target);
+        } else {
+            settle(false);
+        }
+    }
+    return res;
+}